@@ -47,11 +47,23 @@ int main(int argc, char *argv[]) {
 Application::Application(char *infile) {
 	int i;
 	par = new Params();
-	srand (time(NULL));
 	par->setparams(infile);
+	rng.seed(par->SEED, Random::streamOf(RNG_APP, 0, 0));
+	heartbeatLag = 0;
+	heartbeatEntries = 0;
+	cout<<"Run seed: "<<par->SEED<<endl;
 	log = new Log(par);
-	en = new EmulNet(par);
-	en1 = new EmulNet(par);
+	group = NULL;
+	if ( par->TRANSPORT == TRANSPORT_SHM ) {
+		// one thread per process produces into and consumes from its rings
+		par->EN_THREADS = 1;
+		group = new ProcGroup(min(par->SHM_PROCS, par->EN_GPSZ), par->EN_GPSZ);
+	}
+	en = newNetwork(0);
+	en1 = newNetwork(1);
+	en->ENclassify(MP1Node::typeOf, MP1Node::typeNames, DUMMYLASTMSGTYPE);
+	en1->ENclassify(Message::typeOf, Message::typeNames, READREPLY + 1);
+	workers.start(min(par->EN_THREADS, par->EN_GPSZ));
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
 	mp2 = (MP2Node **) malloc(par->EN_GPSZ * sizeof(MP2Node *));
 
@@ -65,6 +77,7 @@ Application::Application(char *infile) {
 		Address joinaddr;
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
+		en1->ENattach(addressOfMemberNode);
 		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
 		mp2[i] = new MP2Node(memberNode, par, en1, log, addressOfMemberNode);
 		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
@@ -86,9 +99,99 @@ Application::~Application() {
 	}
 	free(mp1);
 	free(mp2);
+	delete group;
 	delete par;
 }
 
+/**
+ * FUNCTION NAME: newNetwork
+ *
+ * DESCRIPTION: Create the network of the given lane (0 for MP1, 1 for MP2) over the
+ * 				configured TRANSPORT. UDP lanes get disjoint port ranges, shared memory
+ * 				lanes separate segments of the process group.
+ */
+EmulNet *Application::newNetwork(int lane) {
+	if ( par->TRANSPORT == TRANSPORT_UDP ) {
+		return new UdpNet(par, lane);
+	}
+	if ( par->TRANSPORT == TRANSPORT_SHM ) {
+		return new ShmNet(par, lane, group);
+	}
+	return new EmulNet(par, lane);
+}
+
+/**
+ * FUNCTION NAME: startWorkers
+ *
+ * DESCRIPTION: With the shared memory transport, fork the processes of the group.
+ * 				Each process then logs and reports on its own nodes only, and only
+ * 				the first one writes to the console.
+ */
+void Application::startWorkers() {
+	if ( !multiProcess() ) {
+		return;
+	}
+
+	group->start();
+	int first = group->firstNode(group->index()) + 1;
+	int last = group->firstNode(group->index() + 1);
+	log->keepOnly(first, last);
+	en->ENreportNodes(group->index(), first, last);
+	en1->ENreportNodes(group->index(), first, last);
+	if ( !group->leader() ) {
+		cout.setstate(ios_base::failbit);
+	}
+}
+
+/**
+ * FUNCTION NAME: multiProcess
+ *
+ * DESCRIPTION: Whether the nodes are spread over several processes, each of which
+ * 				only knows the state of its own
+ */
+bool Application::multiProcess() {
+	return group != NULL && group->size() > 1;
+}
+
+/**
+ * FUNCTION NAME: owns
+ *
+ * DESCRIPTION: Whether node index i is stepped by this process
+ */
+bool Application::owns(int i) {
+	return group == NULL || group->owns(i);
+}
+
+/**
+ * FUNCTION NAME: replicasOf
+ *
+ * DESCRIPTION: Replicas of key as node index i sees them. In a multi-process run the
+ * 				process of node i looks them up and hands them to all the others.
+ */
+vector<Node> Application::replicasOf(int i, const string &key) {
+	vector<Node> replicas;
+	Address addrs[RF];
+	int count = 0;
+
+	if ( owns(i) ) {
+		replicas = mp2[i]->findNodes(key);
+	}
+	if ( !multiProcess() ) {
+		return replicas;
+	}
+
+	for ( unsigned int k = 0; k < replicas.size() && k < RF; k++ ) {
+		addrs[count++] = *replicas[k].getAddress();
+	}
+	group->share(group->ownerOf(i), &count, sizeof(count));
+	group->share(group->ownerOf(i), addrs, sizeof(addrs));
+	replicas.clear();
+	for ( int k = 0; k < count; k++ ) {
+		replicas.push_back(Node(addrs[k]));
+	}
+	return replicas;
+}
+
 /**
  * FUNCTION NAME: run
  *
@@ -100,7 +203,8 @@ int Application::run()
 	int timeWhenAllNodesHaveJoined = 0;
 	// boolean indicating if all nodes have joined
 	bool allNodesJoined = false;
-	srand(time(NULL));
+
+	startWorkers();
 
 	// As time runs along
 	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
@@ -118,6 +222,20 @@ int Application::run()
 		}
 		// Fail some nodes
 		//fail();
+		// walks every member list each tick, so only when asked for
+		if ( par->RUN_REPORT && !multiProcess() ) {
+			noteFailures();
+			noteConvergence();
+		}
+	}
+
+	// removals and member lists of other processes' nodes are not at hand here
+	if ( par->RUN_REPORT && !multiProcess() ) {
+		reportDetection();
+		reportConvergence();
+	}
+	if ( par->RUN_REPORT ) {
+		reportOwnership();
 	}
 
 	// Clean up
@@ -128,19 +246,213 @@ int Application::run()
 		 mp1[i]->finishUpThisNode();
 	}
 
+	if ( group ) {
+		group->finish();
+	}
+
 	return SUCCESS;
 }
 
+/**
+ * FUNCTION NAME: noteFailures
+ *
+ * DESCRIPTION: Record the tick at which nodes failed, for reportDetection
+ */
+void Application::noteFailures() {
+	failedAt.resize(par->EN_GPSZ, -1);
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( failedAt[i] < 0 && mp1[i]->getMemberNode()->bFailed ) {
+			failedAt[i] = par->getcurrtime();
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: reportDetection
+ *
+ * DESCRIPTION: Print how well MP1 detected the failures of the run: the latency from a
+ * 				failure to each removal of that node, removals of nodes that were still
+ * 				up (false positives), and live nodes that never removed a failed one
+ */
+void Application::reportDetection() {
+	map<int, int> failedIds;
+	int detections = 0, falsePositives = 0, missed = 0, worst = 0;
+	long latency = 0;
+
+	failedAt.resize(par->EN_GPSZ, -1);
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( failedAt[i] >= 0 ) {
+			failedIds[*(int *)(mp1[i]->getMemberNode()->addr.addr)] = failedAt[i];
+		}
+	}
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		const vector<pair<int, int> > &removals = mp1[i]->getRemovals();
+		unordered_set<int> removed;
+		for ( unsigned int j = 0; j < removals.size(); j++ ) {
+			map<int, int>::iterator failed = failedIds.find(removals[j].first);
+			if ( failed == failedIds.end() || failed->second > removals[j].second ) {
+				falsePositives++;
+				continue;
+			}
+			int took = removals[j].second - failed->second;
+			detections++;
+			latency += took;
+			worst = max(worst, took);
+			removed.insert(removals[j].first);
+		}
+		if ( failedAt[i] < 0 ) {
+			for ( map<int, int>::iterator failed = failedIds.begin(); failed != failedIds.end(); ++failed ) {
+				if ( !removed.count(failed->first) ) {
+					missed++;
+				}
+			}
+		}
+	}
+
+	cout<<endl<<"Failure detection: "<<failedIds.size()<<" failed nodes, "<<detections<<" detections";
+	if ( detections > 0 ) {
+		cout<<", latency mean "<<(double)latency / detections<<" max "<<worst<<" ticks";
+	}
+	cout<<", "<<falsePositives<<" false positives, "<<missed<<" missed"<<endl;
+}
+
+/**
+ * FUNCTION NAME: noteConvergence
+ *
+ * DESCRIPTION: Record for the nodes that just became known to every live node how
+ * 				many ticks after their start that took, and how far the member entries
+ * 				of live nodes trail their owners' heartbeats, for reportConvergence
+ */
+void Application::noteConvergence() {
+	convergedAfter.resize(par->EN_GPSZ, -1);
+	for ( int j = 0; j < par->EN_GPSZ; j++ ) {
+		Member *observer = mp1[j]->getMemberNode();
+		if ( !observer->inGroup || observer->bFailed ) {
+			continue;
+		}
+		for ( unsigned int k = 0; k < observer->memberList.size(); k++ ) {
+			MemberListEntry &entry = observer->memberList[k];
+			int i = entry.getid() - 1;
+			if ( i >= 0 && i < par->EN_GPSZ && i != j && !mp1[i]->getMemberNode()->bFailed ) {
+				heartbeatLag += mp1[i]->getMemberNode()->heartbeat - entry.getheartbeat();
+				heartbeatEntries++;
+			}
+		}
+	}
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		int start = (int)(par->STEP_RATE * i);
+		if ( convergedAfter[i] >= 0 || par->getcurrtime() <= start || mp1[i]->getMemberNode()->bFailed ) {
+			continue;
+		}
+		int id = *(int *)(mp1[i]->getMemberNode()->addr.addr);
+		bool everywhere = true;
+		for ( int j = 0; j < par->EN_GPSZ && everywhere; j++ ) {
+			if ( j != i && par->getcurrtime() > (int)(par->STEP_RATE * j) && !mp1[j]->getMemberNode()->bFailed ) {
+				everywhere = mp1[j]->getMemberNode()->findMember(id) >= 0;
+			}
+		}
+		if ( everywhere ) {
+			convergedAfter[i] = par->getcurrtime() - start;
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: reportConvergence
+ *
+ * DESCRIPTION: Print how long the joins of the run took to reach every live node
+ */
+void Application::reportConvergence() {
+	int converged = 0, worst = 0;
+	long total = 0;
+
+	convergedAfter.resize(par->EN_GPSZ, -1);
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( convergedAfter[i] >= 0 ) {
+			converged++;
+			total += convergedAfter[i];
+			worst = max(worst, convergedAfter[i]);
+		}
+	}
+
+	cout<<"Membership convergence: "<<converged<<" of "<<par->EN_GPSZ<<" joins seen by every live node";
+	if ( converged > 0 ) {
+		cout<<", after mean "<<(double)total / converged<<" max "<<worst<<" ticks";
+	}
+	if ( heartbeatEntries > 0 ) {
+		cout<<", heartbeat lag mean "<<(double)heartbeatLag / heartbeatEntries<<" ticks";
+	}
+	cout<<endl;
+}
+
+/**
+ * FUNCTION NAME: reportOwnership
+ *
+ * DESCRIPTION: Print how evenly the ring of a live node spreads the keys: the share of
+ * 				ring positions of the member that is primary for the most, against the mean
+ */
+void Application::reportOwnership() {
+	map<string, int> share;
+	int most = 0;
+
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( owns(i) && !mp2[i]->getMemberNode()->bFailed && mp2[i]->getMemberNode()->inGroup ) {
+			mp2[i]->ownership(share);
+			break;
+		}
+	}
+	if ( share.empty() ) {
+		return;
+	}
+	for ( map<string, int>::iterator it = share.begin(); it != share.end(); ++it ) {
+		most = max(most, it->second);
+	}
+	cout<<"Key ownership: "<<share.size()<<" members, "<<par->VNODES<<" virtual nodes each, max/mean "<<(double)most * share.size() / RING_SIZE<<endl;
+}
+
+/**
+ * FUNCTION NAME: forEachNode
+ *
+ * DESCRIPTION: Call step(i) for every node index i.
+ * 				With EN_THREADS > 1 the nodes are spread over the worker threads, started
+ * 				once with the application, and the call returns once all of them are
+ * 				done; otherwise the nodes are stepped one at a time in ascending or
+ * 				descending order. In a multi-process run each process steps its own
+ * 				nodes and waits for the others at the end.
+ */
+void Application::forEachNode(bool descending, const function<void(int)> &step) {
+	int i;
+	int count = workers.size();
+
+	if ( count <= 1 ) {
+		for ( i = 0; i < par->EN_GPSZ; i++ ) {
+			int j = descending ? par->EN_GPSZ - 1 - i : i;
+			if ( owns(j) ) {
+				step(j);
+			}
+		}
+		// what a phase sent is in the rings before any process starts the next
+		if ( group ) {
+			group->barrier();
+		}
+		return;
+	}
+
+	workers.run([this, &step, count](int w) {
+		for ( int j = w; j < par->EN_GPSZ; j += count ) {
+			step(j);
+		}
+	});
+}
+
 /**
  * FUNCTION NAME: mp1Run
  *
  * DESCRIPTION:	This function performs all the membership protocol functionalities
  */
 void Application::mp1Run() {
-	int i;
-
 	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	forEachNode(false, [&](int i) {
 
 		/*
 		 * Receive messages from the network and queue them in the membership protocol queue
@@ -150,10 +462,10 @@ void Application::mp1Run() {
 			mp1[i]->recvLoop();
 		}
 
-	}
+	});
 
 	// For all the nodes in the system
-	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
+	forEachNode(true, [&](int i) {
 
 		/*
 		 * Introduce nodes into the distributed system
@@ -161,8 +473,6 @@ void Application::mp1Run() {
 		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
 			// introduce the ith node into the system at time STEPRATE*i
 			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
-			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
-			nodeCount += i;
 		}
 
 		/*
@@ -178,6 +488,15 @@ void Application::mp1Run() {
 			#endif
 		}
 
+	});
+
+	// Announce the nodes introduced this tick. Their addresses were given out before
+	// the run, so every process counts them whichever process started them
+	for ( int i = par->EN_GPSZ - 1; i >= 0; i-- ) {
+		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+			nodeCount += i;
+		}
 	}
 }
 
@@ -190,33 +509,39 @@ void Application::mp1Run() {
  * 				2) CRUD operations
  */
 void Application::mp2Run() {
-	int i;
-
 	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	forEachNode(false, [&](int i) {
 
 		/*
-		 * 1) Update the ring
-		 * 2) Receive messages from the network and queue them in the KV store queue
+		 * Update the ring
 		 */
 		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
 			if ( mp2[i]->getMemberNode()->inited && mp2[i]->getMemberNode()->inGroup ) {
-				// Step 1
 				mp2[i]->updateRing();
 			}
-			// Step 2
+		}
+	});
+
+	/*
+	 * Receive messages from the network and queue them in the KV store queue.
+	 * Stabilization messages sent from updateRing are all queued before any node
+	 * drains its inbox, so what a node receives does not depend on the stepping
+	 * order or on thread timing
+	 */
+	forEachNode(false, [&](int i) {
+		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
 			mp2[i]->recvLoop();
 		}
-	}
+	});
 
 	/**
 	 * Handle messages from the queue and update the DHT
 	 */
-	for ( i = par->EN_GPSZ-1; i >= 0; i-- ) {
+	forEachNode(true, [&](int i) {
 		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
 			mp2[i]->checkMessages();
 		}
-	}
+	});
 
 	/**
 	 * Insert a set of test key value pairs into the system
@@ -342,14 +667,14 @@ void Application::fail() {
 	}
 
 	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
-		removed = (rand() % par->EN_GPSZ);
+		removed = rng.nextInt(par->EN_GPSZ);
 		#ifdef DEBUGLOG
 		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 		#endif
 		mp1[removed]->getMemberNode()->bFailed = true;
 	}
 	else if( par->getcurrtime() == 100 ) {
-		removed = rand() % par->EN_GPSZ/2;
+		removed = rng.nextInt(par->EN_GPSZ/2);
 		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
 			#ifdef DEBUGLOG
 			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
@@ -387,7 +712,7 @@ Address Application::getjoinaddr(void){
 int Application::findARandomNodeThatIsAlive() {
 	int number;
 	do {
-		number = (rand()%par->EN_GPSZ);
+		number = rng.nextInt(par->EN_GPSZ);
 	}while (mp2[number]->getMemberNode()->bFailed);
 	return number;
 }
@@ -398,7 +723,6 @@ int Application::findARandomNodeThatIsAlive() {
  * DESCRIPTION: Init NUMBER_OF_INSERTS test KV pairs in the map
  */
 void Application::initTestKVPairs() {
-	srand(time(NULL));
 	int i;
 	string key;
 	key.clear();
@@ -406,9 +730,9 @@ void Application::initTestKVPairs() {
 	int alphanumLen = sizeof(alphanum) - 1;
 	while ( testKVPairs.size() != NUMBER_OF_INSERTS ) {
 		for ( i = 0; i < KEY_LENGTH; i++ ) {
-			key.push_back(alphanum[rand()%alphanumLen]);
+			key.push_back(alphanum[rng.nextInt(alphanumLen)]);
 		}
-		string value = "value" + to_string(rand()%NUMBER_OF_INSERTS);
+		string value = "value" + to_string(rng.nextInt(NUMBER_OF_INSERTS));
 		testKVPairs[key] = value;
 		key.clear();
 	}
@@ -433,7 +757,9 @@ void Application::insertTestKVPairs() {
 
 		// Step 2. Issue a create operation
 		log->LOG(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientCreate(it->first, it->second);
+		if ( owns(number) ) {
+			mp2[number]->clientCreate(it->first, it->second);
+		}
 	}
 
 	cout<<endl<<"Sent " <<testKVPairs.size() <<" create messages to the ring"<<endl;
@@ -459,7 +785,9 @@ void Application::deleteTest() {
 
 		// Step 1.b. Issue a delete operation
 		log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientDelete(it->first);
+		if ( owns(number) ) {
+			mp2[number]->clientDelete(it->first);
+		}
 	}
 
 	/**
@@ -472,7 +800,9 @@ void Application::deleteTest() {
 
 	// Step 2.b. Issue a delete operation
 	log->LOG(&mp2[number]->getMemberNode()->addr, "DELETE OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
-	mp2[number]->clientDelete(invalidKey);
+	if ( owns(number) ) {
+		mp2[number]->clientDelete(invalidKey);
+	}
 }
 
 /**
@@ -501,7 +831,9 @@ void Application::readTest() {
 		// Step 1.b Do a read operation
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientRead(it->first);
+		if ( owns(number) ) {
+			mp2[number]->clientRead(it->first);
+		}
 	}
 
 	/** end of test1 **/
@@ -515,7 +847,7 @@ void Application::readTest() {
 
 		// Step 2.b Find the replicas of this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = replicasOf(number, it->first);
 		// if less than quorum replicas are found then exit
 		if ( replicas.size() < (RF-1) ) {
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
@@ -560,7 +892,9 @@ void Application::readTest() {
 		// Step 2.d Issue a read
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientRead(it->first);
+		if ( owns(number) ) {
+			mp2[number]->clientRead(it->first);
+		}
 
 		failedOneNode = false;
 	}
@@ -582,7 +916,7 @@ void Application::readTest() {
 
 			// Get the keys replicas
 			replicas.clear();
-			replicas = mp2[number]->findNodes(it->first);
+			replicas = replicasOf(number, it->first);
 
 			// Step 3.b. Fail two replicas
 			//cout<<"REPLICAS SIZE: "<<replicas.size();
@@ -637,7 +971,9 @@ void Application::readTest() {
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should fail since at least quorum nodes are not alive
-			mp2[number]->clientRead(it->first);
+			if ( owns(number) ) {
+				mp2[number]->clientRead(it->first);
+			}
 		}
 
 		/**
@@ -650,7 +986,9 @@ void Application::readTest() {
 			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should be successful
-			mp2[number]->clientRead(it->first);
+			if ( owns(number) ) {
+				mp2[number]->clientRead(it->first);
+			}
 		}
 	}
 
@@ -665,7 +1003,7 @@ void Application::readTest() {
 
 		// Step 4.b Find a non - replica for this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = replicasOf(number, it->first);
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 			if ( !mp2[i]->getMemberNode()->bFailed ) {
 				if ( mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(PRIMARY).getAddress()->getAddress() &&
@@ -694,7 +1032,9 @@ void Application::readTest() {
 		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientRead(it->first);
+		if ( owns(number) ) {
+			mp2[number]->clientRead(it->first);
+		}
 	}
 
 	/** end of test 4 **/
@@ -712,7 +1052,9 @@ void Application::readTest() {
 		cout<<endl<<"Reading an invalid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientRead(invalidKey);
+		if ( owns(number) ) {
+			mp2[number]->clientRead(invalidKey);
+		}
 	}
 
 	/** end of test 5 **/
@@ -746,7 +1088,9 @@ void Application::updateTest() {
 		// Step 1.b Do a update operation
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
-		mp2[number]->clientUpdate(it->first, newValue);
+		if ( owns(number) ) {
+			mp2[number]->clientUpdate(it->first, newValue);
+		}
 	}
 
 	/** end of test 1 **/
@@ -760,7 +1104,7 @@ void Application::updateTest() {
 
 		// Step 2.b Find the replicas of this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = replicasOf(number, it->first);
 		// if quorum replicas are not found then exit
 		if ( replicas.size() < RF-1 ) {
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
@@ -805,7 +1149,9 @@ void Application::updateTest() {
 		// Step 2.d Issue a update
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
-		mp2[number]->clientUpdate(it->first, newValue);
+		if ( owns(number) ) {
+			mp2[number]->clientUpdate(it->first, newValue);
+		}
 
 		failedOneNode = false;
 	}
@@ -827,7 +1173,7 @@ void Application::updateTest() {
 
 			// Get the keys replicas
 			replicas.clear();
-			replicas = mp2[number]->findNodes(it->first);
+			replicas = replicasOf(number, it->first);
 
 			// Step 3.b. Fail two replicas
 			if ( replicas.size() > 2 ) {
@@ -879,7 +1225,9 @@ void Application::updateTest() {
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should fail since at least quorum nodes are not alive
-			mp2[number]->clientUpdate(it->first, newValue);
+			if ( owns(number) ) {
+				mp2[number]->clientUpdate(it->first, newValue);
+			}
 		}
 
 		/**
@@ -892,7 +1240,9 @@ void Application::updateTest() {
 			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should be successful
-			mp2[number]->clientUpdate(it->first, newValue);
+			if ( owns(number) ) {
+				mp2[number]->clientUpdate(it->first, newValue);
+			}
 		}
 	}
 
@@ -907,7 +1257,7 @@ void Application::updateTest() {
 
 		// Step 4.b Find a non - replica for this key
 		replicas.clear();
-		replicas = mp2[number]->findNodes(it->first);
+		replicas = replicasOf(number, it->first);
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 			if ( !mp2[i]->getMemberNode()->bFailed ) {
 				if ( mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(PRIMARY).getAddress()->getAddress() &&
@@ -937,7 +1287,9 @@ void Application::updateTest() {
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientUpdate(it->first, newValue);
+		if ( owns(number) ) {
+			mp2[number]->clientUpdate(it->first, newValue);
+		}
 	}
 
 	/** end of test 4 **/
@@ -956,7 +1308,9 @@ void Application::updateTest() {
 		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", invalidKey.c_str(), invalidValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
-		mp2[number]->clientUpdate(invalidKey, invalidValue);
+		if ( owns(number) ) {
+			mp2[number]->clientUpdate(invalidKey, invalidValue);
+		}
 	}
 
 	/** end of test 5 **/
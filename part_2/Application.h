@@ -13,7 +13,12 @@
 #include "Params.h"
 #include "Member.h"
 #include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
+#include "ProcGroup.h"
 #include "Queue.h"
+#include "Random.h"
+#include "WorkerPool.h"
 #include "MP2Node.h"
 #include "Node.h"
 #include "common.h"
@@ -58,15 +63,39 @@ private:
 	MP2Node **mp2;
 	Params *par;
 	map<string, string> testKVPairs;
+	// random stream for the test driver: failures, test keys
+	Random rng;
+	// threads stepping the nodes when EN_THREADS > 1
+	WorkerPool workers;
+	// processes stepping the nodes with the shared memory transport, NULL otherwise
+	ProcGroup *group;
+	// tick at which each node failed, -1 while it is up
+	vector<int> failedAt;
+	// ticks from each node's start until every live node had it as a member, -1 until then
+	vector<int> convergedAfter;
+	// how far behind its owner's heartbeat each member entry was, summed over the run
+	long long heartbeatLag;
+	long long heartbeatEntries;
 public:
 	Application(char *);
 	virtual ~Application();
 	Address getjoinaddr();
+	EmulNet *newNetwork(int lane);
+	void startWorkers();
+	bool owns(int i);
+	bool multiProcess();
+	vector<Node> replicasOf(int i, const string &key);
 	void initTestKVPairs();
 	int run();
+	void forEachNode(bool descending, const function<void(int)> &step);
 	void mp1Run();
 	void mp2Run();
 	void fail();
+	void noteFailures();
+	void reportDetection();
+	void noteConvergence();
+	void reportConvergence();
+	void reportOwnership();
 	void insertTestKVPairs();
 	int findARandomNodeThatIsAlive();
 	void deleteTest();
@@ -9,169 +9,448 @@
 /**
  * Constructor
  */
-EmulNet::EmulNet(Params *p)
+EmulNet::EmulNet(Params *p, int lane): link(p, lane), lane(lane), classifier(NULL)
 {
 	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
 	par = p;
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
+	emulnet.peakbuffsize = 0;
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
-	}
+	firstId = 1;
+	lastId = par->EN_GPSZ;
+	part = 0;
+	pool.setThreadSafe(par->EN_THREADS > 1);
 	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
 
 /**
- * Copy constructor
+ * Destructor
  */
-EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
+EmulNet::~EmulNet() {
+	for ( unsigned int i = 0; i < emulnet.shards.size(); i++ ) {
+		delete emulnet.shards[i];
 	}
-	this->emulnet = anotherEmulNet.emulnet;
 }
 
 /**
- * Assignment operator overloading
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Init the emulnet for this node
  */
-EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
-	this->par = anotherEmulNet.par;
-	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
+void *EmulNet::ENinit(Address *myaddr, short port) {
+	// Initialize data structures for this member
+	*(int *)(myaddr->addr) = emulnet.nextid++;
+    *(short *)(&myaddr->addr[4]) = 0;
+	ENattach(myaddr);
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: ENattach
+ *
+ * DESCRIPTION: Set up the per node state for an address, e.g. one assigned by
+ * 				another EmulNet's ENinit. Every node must be attached before any
+ * 				node sends or receives.
+ */
+void EmulNet::ENattach(Address *myaddr) {
+	int id = *(int *)(myaddr->addr);
+	emulnet.addShard(id);
+	stats.addNode(id);
+	link.addNode(id);
+	while ( id >= (int)rngs.size() ) {
+		rngs.push_back(Random(par->SEED, Random::streamOf(RNG_NET, lane, rngs.size())));
+	}
+	if ( id >= (int)seqs.size() ) {
+		seqs.resize(id + 1, 0);
 	}
-	this->emulnet = anotherEmulNet.emulnet;
-	return *this;
 }
 
 /**
- * Destructor
+ * FUNCTION NAME: ENclassify
+ *
+ * DESCRIPTION: Turn on per message type accounting. fn maps a payload to an index
+ * 				into names; anything else is counted as "other".
+ * 				Call before any node sends.
  */
-EmulNet::~EmulNet() {}
+void EmulNet::ENclassify(msgClassifier fn, const char * const *names, int count) {
+	classifier = fn;
+	typeNames.assign(names, names + count);
+}
 
 /**
- * FUNCTION NAME: ENinit
+ * FUNCTION NAME: ENreportNodes
  *
- * DESCRIPTION: Init the emulnet for this node
+ * DESCRIPTION: Limit the statistics ENcleanup writes to node ids firstId .. lastId, the
+ * 				nodes this process stepped. Every part but 0 writes its files with its
+ * 				part number as suffix, e.g. msgcount.log.1, next to those of part 0.
  */
-void *EmulNet::ENinit(Address *myaddr, short port) {
-	// Initialize data structures for this member
-	*(int *)(myaddr->addr) = emulnet.nextid++;
-    *(short *)(&myaddr->addr[4]) = 0;
-	return myaddr;
+void EmulNet::ENreportNodes(int part, int firstId, int lastId) {
+	this->part = part;
+	this->firstId = firstId;
+	this->lastId = lastId;
 }
 
 /**
- * FUNCTION NAME: ENsend
+ * FUNCTION NAME: typeOf
  *
- * DESCRIPTION: EmulNet send function
+ * DESCRIPTION: Type index of a payload for the per type counters
+ */
+int EmulNet::typeOf(char *payload, int size) {
+	int type = classifier ? (*classifier)(payload, size) : -1;
+	return ( type >= 0 && type < (int)typeNames.size() ) ? type : typeNames.size();
+}
+
+/**
+ * FUNCTION NAME: frameOf
+ *
+ * DESCRIPTION: Frame that carries the given payload
+ */
+en_frame *EmulNet::frameOf(char *buffer) {
+	return (en_frame *)buffer - 1;
+}
+
+/**
+ * FUNCTION NAME: deliveredBefore
+ *
+ * DESCRIPTION: Order in which a node receives the frames of one ENrecv: by due tick,
+ * 				then by sender id, then in the order the sender sent them
+ */
+bool EmulNet::deliveredBefore(en_frame *a, en_frame *b) {
+	int fromA = *(int *)(a->msg.from.addr);
+	int fromB = *(int *)(b->msg.from.addr);
+	if ( a->due != b->due ) {
+		return a->due < b->due;
+	}
+	if ( fromA != fromB ) {
+		return fromA < fromB;
+	}
+	return a->seq < b->seq;
+}
+
+/**
+ * FUNCTION NAME: newFrame
+ *
+ * DESCRIPTION: Take a frame with room for size bytes of payload from the pool
+ */
+en_frame *EmulNet::newFrame(int size) {
+	en_frame *f = (en_frame *)pool.alloc(sizeof(en_frame) + size);
+	f->refs = 1;
+	f->body = NULL;
+	f->patchAt = -1;
+	f->msg.size = size;
+	return f;
+}
+
+/**
+ * FUNCTION NAME: releaseFrame
+ *
+ * DESCRIPTION: Drop one reference to a frame, returning it to the pool with the last one
+ */
+void EmulNet::releaseFrame(en_frame *f) {
+	if ( --f->refs > 0 ) {
+		return;
+	}
+	if ( f->body ) {
+		releaseFrame(f->body);
+	}
+	pool.release(f, sizeof(en_frame) + f->msg.size);
+}
+
+/**
+ * FUNCTION NAME: ENalloc
+ *
+ * DESCRIPTION: Allocate a message frame from the pool and return its payload area.
+ * 				The sender fills the payload in place and hands it to ENsendBuffer,
+ * 				which transfers ownership of the frame to the network.
  *
  * RETURNS:
- * size
+ * pointer to size bytes of payload
  */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
-	en_msg *em;
-	static char temp[2048];
-	int sendmsg = rand() % 100;
+char *EmulNet::ENalloc(int size) {
+	return (char *)(newFrame(size) + 1);
+}
 
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
-		return 0;
+/**
+ * FUNCTION NAME: ENfree
+ *
+ * DESCRIPTION: Release a payload obtained from ENalloc or delivered by ENrecv
+ */
+void EmulNet::ENfree(char *buffer) {
+	if ( buffer ) {
+		releaseFrame(frameOf(buffer));
 	}
+}
 
-	em = (en_msg *)malloc(sizeof(en_msg) + size);
-	em->size = size;
+/**
+ * FUNCTION NAME: ENsendBuffer
+ *
+ * DESCRIPTION: EmulNet send function for a payload allocated with ENalloc.
+ * 				The frame is queued as is; the caller must not touch the buffer afterwards,
+ * 				even when the message is dropped.
+ * 				Once EN_BUFF_SIZE messages are in flight the network pushes back instead of
+ * 				queueing; the sender may send the message again on a later tick.
+ *
+ * RETURNS:
+ * size, EN_BACKPRESSURE if the network is full or EN_DROPPED if the message was lost
+ */
+int EmulNet::ENsendBuffer(Address *myaddr, Address *toaddr, char *buffer) {
+	en_frame *f = frameOf(buffer);
+	return enqueue(myaddr, toaddr, f, f->msg.size);
+}
 
-	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
-	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
-	memcpy(em + 1, data, size);
+/**
+ * FUNCTION NAME: ENsendMulti
+ *
+ * DESCRIPTION: Send one payload allocated with ENalloc to count destinations.
+ * 				The payload is shared, not copied: each destination gets a small frame
+ * 				referencing it. When patches is given, destination i receives the payload
+ * 				with the byte at patchAt set to patches[i]; a receiver only gets its own
+ * 				copy if the byte differs while other destinations still hold the payload.
+ * 				As with ENsendBuffer the caller gives up the buffer. results, if given,
+ * 				receives what ENsendBuffer would have returned for each destination.
+ *
+ * RETURNS:
+ * number of destinations the message was queued for
+ */
+int EmulNet::ENsendMulti(Address *myaddr, Address *toaddrs, int count, char *buffer, int patchAt, const char *patches, int *results) {
+	en_frame *b = frameOf(buffer);
+	int queued = 0;
+
+	for ( int i = 0; i < count; i++ ) {
+		en_frame *d = newFrame(0);
+		b->refs++;
+		d->body = b;
+		if ( patches ) {
+			d->patchAt = patchAt;
+			d->patch = patches[i];
+		}
+		int rt = enqueue(myaddr, &toaddrs[i], d, b->msg.size);
+		if ( results ) {
+			results[i] = rt;
+		}
+		if ( rt > 0 ) {
+			queued++;
+		}
+	}
+	releaseFrame(b);
 
-	emulnet.buff[emulnet.currbuffsize++] = em;
+	return queued;
+}
 
+/**
+ * FUNCTION NAME: enqueue
+ *
+ * DESCRIPTION: Queue a frame carrying size bytes of payload for toaddr, or drop it
+ *
+ * RETURNS:
+ * size, EN_BACKPRESSURE or EN_DROPPED
+ */
+int EmulNet::enqueue(Address *myaddr, Address *toaddr, en_frame *f, int size) {
+	en_msg *em = &f->msg;
 	int src = *(int *)(myaddr->addr);
-	int time = par->getcurrtime();
+	int dst = *(int *)(toaddr->addr);
+	ENshard *shard = emulnet.shardOf(dst);
+
+	if ( shard == NULL ) {
+		return drop(src, f, DROP_UNREACHABLE);
+	}
+	if ( size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE ) {
+		return drop(src, f, DROP_TOO_BIG);
+	}
+	if ( par->dropmsg && rngs[src].nextInt(100) < (int) (par->MSG_DROP_PROB * 100) ) {
+		return drop(src, f, DROP_LOSS);
+	}
+	if ( !emulnet.reserve(par->EN_BUFF_SIZE) ) {
+		return pushBack(src, f);
+	}
 
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
+	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
+	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
 
-	sent_msgs[src][time]++;
+	int time = par->getcurrtime();
+	f->due = link.isEnabled() ? link.dueTime(src, dst, size, time) : time;
+	f->seq = seqs[src]++;
+	// the transport may release the frame once posted
+	int type = typeOf((char *)((f->body ? f->body : f) + 1), size);
+
+	if ( !post(src, dst, shard, f) ) {
+		emulnet.currbuffsize--;
+		return pushBack(src, f);
+	}
 
-	#ifdef DEBUGLOG
-		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
-	#endif
+	stats.countSent(src, time, size);
+	stats.countTypeSent(src, type, size);
 
 	return size;
 }
 
+/**
+ * FUNCTION NAME: drop
+ *
+ * DESCRIPTION: Release a frame the network lost and account it to its sender
+ *
+ * RETURNS:
+ * EN_DROPPED
+ */
+int EmulNet::drop(int src, en_frame *f, dropCause cause) {
+	releaseFrame(f);
+	stats.countDrop(src, par->getcurrtime(), cause);
+	return EN_DROPPED;
+}
+
+/**
+ * FUNCTION NAME: pushBack
+ *
+ * DESCRIPTION: Release a frame the network has no room for and account it to its
+ * 				sender. It is not lost: the sender is expected to send it again.
+ *
+ * RETURNS:
+ * EN_BACKPRESSURE
+ */
+int EmulNet::pushBack(int src, en_frame *f) {
+	releaseFrame(f);
+	stats.countPushback(src, par->getcurrtime());
+	return EN_BACKPRESSURE;
+}
+
+/**
+ * FUNCTION NAME: post
+ *
+ * DESCRIPTION: Put an accepted frame on its way to node dst.
+ * 				In memory it goes straight into the destination's shard.
+ *
+ * RETURNS:
+ * false if the transport has no room for it, the caller then still owns the frame
+ */
+bool EmulNet::post(int src, int dst, ENshard *shard, en_frame *f) {
+	shard->incoming.push(f);
+	return true;
+}
+
+/**
+ * FUNCTION NAME: collect
+ *
+ * DESCRIPTION: Move frames that reached node dst into its shard.
+ * 				Nothing to do in memory, post already put them there.
+ */
+void EmulNet::collect(int dst, ENshard *shard) {
+}
+
+/**
+ * FUNCTION NAME: deliver
+ *
+ * DESCRIPTION: Turn a frame taken off a shard into the payload handed to the receiver.
+ * 				A shared body is passed on as is when it already reads right for this
+ * 				destination, patched in place when no one else holds it, and copied otherwise.
+ *
+ * RETURNS:
+ * payload, to be released with ENfree
+ */
+char *EmulNet::deliver(en_frame *f) {
+	en_frame *b = f->body;
+
+	if ( b == NULL ) {
+		return (char *)(f + 1);
+	}
+
+	// keep the descriptor's reference to the body for the receiver
+	int patchAt = f->patchAt;
+	char patch = f->patch;
+	f->body = NULL;
+	releaseFrame(f);
+
+	char *payload = (char *)(b + 1);
+	if ( patchAt >= 0 && payload[patchAt] != patch ) {
+		if ( b->refs > 1 ) {
+			char *copy = ENalloc(b->msg.size);
+			memcpy(copy, payload, b->msg.size);
+			releaseFrame(b);
+			payload = copy;
+		}
+		payload[patchAt] = patch;
+	}
+	return payload;
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: EmulNet send function
+ *
+ * RETURNS:
+ * size, EN_BACKPRESSURE if the network is full or EN_DROPPED if the message was lost
+ */
+int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	char *buffer = ENalloc(size);
+	memcpy(buffer, data, size);
+	return ENsendBuffer(myaddr, toaddr, buffer);
+}
+
 /**
  * FUNCTION NAME: ENsend
  *
  * DESCRIPTION: EmulNet send function
  *
  * RETURNS:
- * size
+ * size, EN_BACKPRESSURE if the network is full or EN_DROPPED if the message was lost
  */
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
-	return ret;
+	char *buffer = ENalloc(data.size());
+	memcpy(buffer, data.data(), data.size());
+	return ENsendBuffer(myaddr, toaddr, buffer);
 }
 
 /**
  * FUNCTION NAME: ENrecv
  *
  * DESCRIPTION: EmulNet receive function
+ * 				Drains this node's shard only, so a call costs O(messages delivered).
+ * 				Messages whose link delay has not elapsed yet are parked in the shard's
+ * 				timing wheel. Payloads are handed over without copying; the consumer
+ * 				releases each one with ENfree once it is done with it.
  *
  * RETURN:
  * 0
  */
 int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
 	// times is always assumed to be 1
-	int i;
-	char* tmp;
-	int sz;
-	en_msg *emsg;
-
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
-
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
-
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
+	int dst = *(int *)(myaddr->addr);
+	int time = par->getcurrtime();
+	ENshard *shard = emulnet.shardOf(dst);
+	vector<en_frame *> ready;
+	en_frame *f;
 
-			(*enq)(queue, (char *)tmp, sz);
+	if ( shard == NULL ) {
+		return 0;
+	}
 
-			free(emsg);
+	collect(dst, shard);
+	while ( (f = shard->incoming.pop()) != NULL ) {
+		if ( f->due > time ) {
+			shard->delayed.schedule(f->due, f);
+		}
+		else {
+			ready.push_back(f);
+		}
+	}
+	shard->delayed.advance(time, ready);
+	// the same order whichever threads or transport carried the frames and in
+	// whatever order the senders were stepped
+	sort(ready.begin(), ready.end(), deliveredBefore);
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+	for ( unsigned int i = 0; i < ready.size(); i++ ) {
+		char *payload = deliver(ready[i]);
+		int size = frameOf(payload)->msg.size;
+		int type = typeOf(payload, size);
+		emulnet.currbuffsize--;
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+		(*enq)(queue, payload, size);
 
-			recv_msgs[dst][time]++;
-		}
+		stats.countRecv(dst, time, size);
+		stats.countTypeRecv(dst, type, size);
 	}
+	stats.setDepth(dst, time, shard->delayed.size());
 
 	return 0;
 }
@@ -185,36 +464,79 @@ int EmulNet::ENcleanup() {
 	emulnet.nextid=0;
 	int i, j;
 	int sent_total, recv_total;
+	int sent, recv;
 
-	FILE* file = fopen("msgcount.log", "w+");
+	string suffix = ( part > 0 ) ? "." + to_string(part) : "";
+	FILE* file = fopen(("msgcount.log" + suffix).c_str(), "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int)emulnet.shards.size(); i++ ) {
+		vector<en_frame *> pending;
+		en_frame *f;
+		emulnet.shards[i]->delayed.drain(pending);
+		while ( (f = emulnet.shards[i]->incoming.pop()) != NULL ) {
+			pending.push_back(f);
+		}
+		for ( j = 0; j < (int)pending.size(); j++ ) {
+			releaseFrame(pending[j]);
+		}
 	}
+	emulnet.currbuffsize = 0;
 
-	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+	for ( i = firstId; i <= lastId; i++ ) {
 		fprintf(file, "node %3d ", i);
 		sent_total = 0;
 		recv_total = 0;
 
 		for (j = 0; j < par->getcurrtime(); j++) {
 
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
-			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
-				if (j % 10 == 9) {
-					fprintf(file, "\n         ");
-				}
-			}
-			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+			sent = stats.getSent(i, j);
+			recv = stats.getRecv(i, j);
+			sent_total += sent;
+			recv_total += recv;
+			fprintf(file, " (%4d, %4d)", sent, recv);
+			if (j % 10 == 9) {
+				fprintf(file, "\n         ");
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d dropped", i);
+		for ( j = 0; j < DROP_CAUSES; j++ ) {
+			fprintf(file, " %s %d", NetStats::causeName((dropCause)j), stats.getDrops(i, (dropCause)j));
+		}
+		fprintf(file, "\nnode %3d pushed_back %d\n\n", i, stats.getPushbacks(i));
 	}
 
+	fprintf(file, "in flight peak %d, cap %d\n", emulnet.getPeakBuffSize(), par->EN_BUFF_SIZE);
+	pool.printStats(file, "frame");
+
 	fclose(file);
+
+	// every network adds its own table, the first one starts the file
+	file = fopen(("msgtypes.log" + suffix).c_str(), lane == 0 ? "w" : "a");
+	if ( file ) {
+		string layer = ( lane == 0 ) ? "en" : "en" + to_string(lane);
+		long long sentBytes = 0;
+		for ( j = 0; j <= (int)typeNames.size(); j++ ) {
+			sentBytes += stats.getTypeTotal(j).sentBytes;
+		}
+		fprintf(file, "layer %s\n", layer.c_str());
+		fprintf(file, "%-12s %10s %12s %10s %12s %7s\n", "type", "sent_msgs", "sent_bytes", "recv_msgs", "recv_bytes", "share");
+		for ( j = 0; j <= (int)typeNames.size(); j++ ) {
+			type_count c = stats.getTypeTotal(j);
+			if ( c.sent == 0 && c.recv == 0 ) {
+				continue;
+			}
+			fprintf(file, "%-12s %10d %12lld %10d %12lld %6.1f%%\n", j < (int)typeNames.size() ? typeNames[j].c_str() : "other",
+					c.sent, c.sentBytes, c.recv, c.recvBytes, sentBytes ? 100.0 * c.sentBytes / sentBytes : 0.0);
+		}
+		fprintf(file, "\n");
+		fclose(file);
+	}
+
+	if ( par->STATS_EXPORT ) {
+		string path = "netstats" + to_string(lane) + suffix + ".bin";
+		stats.exportBinary(path.c_str(), firstId, lastId, par->getcurrtime());
+	}
 	return 0;
 }
@@ -7,16 +7,25 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
-#define MAX_TIME 3600
-#define ENBUFFSIZE 30000
+// ENsendBuffer results other than the payload size
+#define EN_DROPPED 0
+#define EN_BACKPRESSURE -1
 
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "MsgPool.h"
+#include "NetStats.h"
+#include "LinkModel.h"
+#include "TimingWheel.h"
+#include "MpscQueue.h"
+#include "Random.h"
 
 using namespace std;
 
+// tells the message type of a payload, as an index into the names given to ENclassify
+typedef int (*msgClassifier)(char *payload, int size);
+
 /**
  * Struct Name: en_msg
  */
@@ -29,26 +38,73 @@ typedef struct en_msg {
 	Address to;
 }en_msg;
 
+/**
+ * Struct Name: en_frame
+ *
+ * DESCRIPTION: Envelope of a message while the network owns it.
+ * 				The payload follows the frame in memory.
+ * 				ENsendMulti queues one small frame per destination instead, each pointing
+ * 				at a shared body frame and naming the byte to patch before delivery.
+ */
+typedef struct en_frame {
+	// link in the destination's incoming queue
+	atomic<struct en_frame *> next;
+	// first tick at which the message may be received
+	int due;
+	// how many messages its sender had sent before it
+	unsigned int seq;
+	// holders of the payload, more than one while a body is shared
+	atomic<int> refs;
+	// per destination frames only: shared frame carrying the payload
+	struct en_frame *body;
+	// payload[patchAt] = patch on delivery, patchAt < 0 for none
+	int patchAt;
+	char patch;
+	en_msg msg;
+}en_frame;
+
+/**
+ * Class Name: ENshard
+ *
+ * DESCRIPTION: Receive side of one destination node.
+ * 				Senders push into incoming from any thread; the node's own ENrecv is the
+ * 				only consumer, and it alone owns the delayed wheel.
+ */
+class ENshard {
+public:
+	MpscQueue<en_frame> incoming;
+	TimingWheel<en_frame*> delayed;
+	ENshard() {}
+	virtual ~ENshard() {}
+};
+
 /**
  * Class Name: EM
+ *
+ * DESCRIPTION: In-flight messages, sharded by destination node id.
+ * 				currbuffsize counts the messages across all shards, peakbuffsize
+ * 				the most it has ever held.
  */
 class EM {
 public:
 	int nextid;
-	int currbuffsize;
+	atomic<int> currbuffsize;
+	atomic<int> peakbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	vector<ENshard *> shards;
 	EM() {}
-	EM& operator = (EM &anotherEM) {
-		this->nextid = anotherEM.getNextId();
-		this->currbuffsize = anotherEM.getCurrBuffSize();
-		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
+	// the shards belong to the EmulNet, a copy would free them twice
+	EM(const EM &) = delete;
+	EM& operator = (const EM &) = delete;
+	// shards are created by ENinit, before any node runs
+	void addShard(int id) {
+		assert(id >= 0);
+		while ( id >= (int)shards.size() ) {
+			shards.push_back(new ENshard());
 		}
-		return *this;
+	}
+	ENshard *shardOf(int id) {
+		return ( id >= 0 && id < (int)shards.size() ) ? shards[id] : NULL;
 	}
 	int getNextId() {
 		return nextid;
@@ -56,6 +112,20 @@ public:
 	int getCurrBuffSize() {
 		return currbuffsize;
 	}
+	int getPeakBuffSize() {
+		return peakbuffsize;
+	}
+	// take one slot, fails once cap messages are in flight (cap 0: no limit)
+	bool reserve(int cap) {
+		int inflight = ++currbuffsize;
+		if ( cap > 0 && inflight > cap ) {
+			currbuffsize--;
+			return false;
+		}
+		int peak = peakbuffsize;
+		while ( inflight > peak && !peakbuffsize.compare_exchange_weak(peak, inflight) ) {}
+		return true;
+	}
 	int getFirstEltIndex() {
 		return firsteltindex;
 	}
@@ -75,25 +145,60 @@ public:
  * CLASS NAME: EmulNet
  *
  * DESCRIPTION: This class defines an emulated network
+ * 				Different nodes may call ENsend/ENrecv from different threads at the
+ * 				same time, as long as each node is driven by one thread at a time and
+ * 				all nodes have been through ENinit first.
  */
 class EmulNet
 { 	
-private:
+protected:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	NetStats stats;
 	int enInited;
 	EM emulnet;
+	MsgPool pool;
+	LinkModel link;
+	// which of the application's networks this is, keeps the random streams apart
+	int lane;
+	// node ids ENcleanup reports on, and the process of a multi-process run it reports for
+	int firstId;
+	int lastId;
+	int part;
+	// per sending node: message loss draws
+	vector<Random> rngs;
+	// per sending node: sequence number of its next message
+	vector<unsigned int> seqs;
+	// per type accounting, the last type counts what the classifier could not place
+	msgClassifier classifier;
+	vector<string> typeNames;
+	int typeOf(char *payload, int size);
+	static en_frame *frameOf(char *buffer);
+	static bool deliveredBefore(en_frame *a, en_frame *b);
+	en_frame *newFrame(int size);
+	void releaseFrame(en_frame *f);
+	int enqueue(Address *myaddr, Address *toaddr, en_frame *f, int size);
+	int drop(int src, en_frame *f, dropCause cause);
+	int pushBack(int src, en_frame *f);
+	char *deliver(en_frame *f);
+	virtual bool post(int src, int dst, ENshard *shard, en_frame *f);
+	virtual void collect(int dst, ENshard *shard);
 public:
- 	EmulNet(Params *p);
- 	EmulNet(EmulNet &anotherEmulNet);
- 	EmulNet& operator = (EmulNet &anotherEmulNet);
+ 	EmulNet(Params *p, int lane);
+ 	EmulNet(const EmulNet &) = delete;
+ 	EmulNet& operator = (const EmulNet &) = delete;
  	virtual ~EmulNet();
 	void *ENinit(Address *myaddr, short port);
+	virtual void ENattach(Address *myaddr);
+	void ENclassify(msgClassifier fn, const char * const *names, int count);
+	void ENreportNodes(int part, int firstId, int lastId);
+	char *ENalloc(int size);
+	void ENfree(char *buffer);
+	int ENsendBuffer(Address *myaddr, Address *toaddr, char *buffer);
+	int ENsendMulti(Address *myaddr, Address *toaddrs, int count, char *buffer, int patchAt, const char *patches, int *results);
 	int ENsend(Address *myaddr, Address *toaddr, string data);
 	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
 	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
-	int ENcleanup();
+	virtual int ENcleanup();
 };
 
 #endif /* _EMULNET_H_ */
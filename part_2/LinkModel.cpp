@@ -0,0 +1,112 @@
+/**********************************
+ * FILE NAME: LinkModel.cpp
+ *
+ * DESCRIPTION: Definition of the link latency and bandwidth model
+ **********************************/
+
+#include "LinkModel.h"
+
+/**
+ * Constructor
+ */
+LinkModel::LinkModel(Params *p, int lane): par(p), lane(lane) {}
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Make room for the per sender state of node id
+ */
+void LinkModel::addNode(int id) {
+	if ( id >= (int)busyUntil.size() ) {
+		busyUntil.resize(id + 1, 0);
+		resolved.resize(id + 1);
+	}
+	while ( id >= (int)rngs.size() ) {
+		rngs.push_back(Random(par->SEED, Random::streamOf(RNG_LINK, lane, rngs.size())));
+	}
+}
+
+/**
+ * FUNCTION NAME: isEnabled
+ *
+ * DESCRIPTION: True if any delay or bandwidth cap is configured
+ */
+bool LinkModel::isEnabled() {
+	return !par->LINK_DELAYS.empty() || par->NODE_BANDWIDTH > 0;
+}
+
+/**
+ * FUNCTION NAME: lookup
+ *
+ * DESCRIPTION: Most specific LINK_DELAY entry for the link, cached per link.
+ * 				An exact (from, to) match beats (from, any), which beats (any, to),
+ * 				which beats (any, any).
+ */
+const LinkDelay *LinkModel::lookup(int from, int to) {
+	addNode(from);
+	unordered_map<int, const LinkDelay *> &cache = resolved[from];
+	unordered_map<int, const LinkDelay *>::iterator it = cache.find(to);
+	if ( it != cache.end() ) {
+		return it->second;
+	}
+
+	const LinkDelay *best = NULL;
+	int bestRank = -1;
+	for ( unsigned int i = 0; i < par->LINK_DELAYS.size(); i++ ) {
+		const LinkDelay &ld = par->LINK_DELAYS[i];
+		if ( (ld.from != 0 && ld.from != from) || (ld.to != 0 && ld.to != to) ) {
+			continue;
+		}
+		int rank = (ld.from != 0 ? 2 : 0) + (ld.to != 0 ? 1 : 0);
+		if ( rank > bestRank ) {
+			best = &ld;
+			bestRank = rank;
+		}
+	}
+	cache[to] = best;
+	return best;
+}
+
+/**
+ * FUNCTION NAME: sampleDelay
+ *
+ * DESCRIPTION: Draw a propagation delay in whole ticks from the sender's stream
+ */
+int LinkModel::sampleDelay(int from, const LinkDelay *ld) {
+	double u = rngs[from].nextDouble();
+	double d;
+
+	switch ( ld->dist ) {
+	case DELAY_UNIFORM:
+		d = ld->a + u * (ld->b - ld->a);
+		break;
+	case DELAY_EXP:
+		d = ld->a - ld->b * log(u);
+		break;
+	default:
+		d = ld->a;
+		break;
+	}
+	return d > 0 ? (int)(d + 0.5) : 0;
+}
+
+/**
+ * FUNCTION NAME: dueTime
+ *
+ * DESCRIPTION: Tick at which a message of size bytes sent at tick now on the
+ * 				link from -> to can be received
+ */
+int LinkModel::dueTime(int from, int to, int size, int now) {
+	int depart = now;
+
+	if ( par->NODE_BANDWIDTH > 0 ) {
+		addNode(from);
+		double start = max((double)now, busyUntil[from]);
+		busyUntil[from] = start + (double)size / par->NODE_BANDWIDTH;
+		// the message leaves in the tick its last byte is put on the wire
+		depart = max(now, (int)ceil(busyUntil[from]) - 1);
+	}
+
+	const LinkDelay *ld = lookup(from, to);
+	return ld ? depart + sampleDelay(from, ld) : depart;
+}
@@ -0,0 +1,46 @@
+/**********************************
+ * FILE NAME: LinkModel.h
+ *
+ * DESCRIPTION: Header file of the link latency and bandwidth model
+ **********************************/
+
+#ifndef LINKMODEL_H_
+#define LINKMODEL_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Random.h"
+#include <unordered_map>
+
+/**
+ * CLASS NAME: LinkModel
+ *
+ * DESCRIPTION: Decides the tick at which a message becomes deliverable.
+ * 				A message first waits for its sender's egress link (NODE_BANDWIDTH bytes
+ * 				per tick) and then for a delay drawn from the most specific LINK_DELAY
+ * 				entry matching (from, to). With nothing configured every message is due
+ * 				in the tick it was sent, which is the plain EmulNet behaviour.
+ * 				All state is kept per sending node, so different senders may use the
+ * 				model from different threads.
+ */
+class LinkModel {
+private:
+	Params *par;
+	// per sending node: to -> matching LINK_DELAY entry, or NULL for none
+	vector< unordered_map<int, const LinkDelay *> > resolved;
+	// per sending node: time at which its egress link becomes idle
+	vector<double> busyUntil;
+	// per sending node: delay samples
+	vector<Random> rngs;
+	int lane;
+	const LinkDelay *lookup(int from, int to);
+	int sampleDelay(int from, const LinkDelay *ld);
+public:
+	LinkModel(Params *p, int lane);
+	void addNode(int id);
+	bool isEnabled();
+	int dueTime(int from, int to, int size, int now);
+	virtual ~LinkModel() {}
+};
+
+#endif /* LINKMODEL_H_ */
@@ -29,11 +29,15 @@ class Log{
 private:
 	Params *par;
 	bool firstTime;
+	// node ids whose messages are written, the others belong to another process
+	int firstId;
+	int lastId;
 public:
 	Log(Params *p);
 	Log(const Log &anotherLog);
 	Log& operator = (const Log &anotherLog);
 	virtual ~Log();
+	void keepOnly(int firstId, int lastId);
 	void LOG(Address *, const char * str, ...);
 	void logNodeAdd(Address *, Address *);
 	void logNodeRemove(Address *, Address *);
@@ -11,6 +11,9 @@
  * Note: You can change/add any functions in MP1Node.{h,cpp}
  */
 
+// names of the MsgTypes, for the network's per type accounting
+const char * const MP1Node::typeNames[DUMMYLASTMSGTYPE] = { "JOINREQ", "JOINREP", "GOSSIP", "PING", "ACK", "PINGREQ" };
+
 /**
  * Overloaded Constructor of the MP1Node class
  * You can add new members to the class if you think it
@@ -25,8 +28,20 @@ MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Addres
 	this->log = log;
 	this->par = params;
 	this->memberNode->addr = *address;
-
-    srand (time(NULL));
+	this->rng.seed(par->SEED, Random::streamOf(RNG_MP1, 0, *(int *)(address->addr)));
+	this->phiSigma = phiSigmas(par->PHI_THRESHOLD);
+	this->gossipRound = 0;
+	this->gossipTicks.assign(par->GOSSIP_RETRANSMIT, -1);
+	this->probeNext = 0;
+	this->probeTarget = -1;
+	this->probeSeq = 0;
+	this->probeStart = -par->SWIM_PERIOD;
+	this->probeAcked = false;
+	this->probeIndirect = false;
+	this->nextSeq = 1;
+	this->joining = false;
+	this->joinMissing = 0;
+	this->joinAsked = 0;
 }
 
 /**
@@ -34,6 +49,18 @@ MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Addres
  */
 MP1Node::~MP1Node() {}
 
+/**
+ * FUNCTION NAME: typeOf
+ *
+ * DESCRIPTION: Message type of a payload sent by MP1Node, -1 if it has no header
+ */
+int MP1Node::typeOf(char *data, int size) {
+	if ( size < (int)sizeof(MessageHdr) ) {
+		return -1;
+	}
+	return ((MessageHdr *)data)->msgType;
+}
+
 /**
  * FUNCTION NAME: recvLoop
  *
@@ -120,9 +147,8 @@ int MP1Node::initThisNode(Address *joinaddr) {
  * DESCRIPTION: Join the distributed system
  */
 int MP1Node::introduceSelfToGroup(Address *joinaddr) {
-	MessageHdr *msg;
 #ifdef DEBUGLOG
-    static char s[1024];
+    char s[1024];
 #endif
 
     if ( 0 == memcmp((char *)&(memberNode->addr.addr), (char *)&(joinaddr->addr), sizeof(memberNode->addr.addr))) {
@@ -134,23 +160,15 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
         log->logNodeAdd(&memberNode->addr,&memberNode->addr);
     }
     else {
-        size_t msgsize = sizeof(MessageHdr) + sizeof(joinaddr->addr) + sizeof(long) + 1;
-        msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-
-        // create JOINREQ message: format of data is {struct Address myaddr}
-        msg->msgType = JOINREQ;
-        memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-        memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
-
 #ifdef DEBUGLOG
         sprintf(s, "Trying to join...");
         log->LOG(&memberNode->addr, s);
 #endif
 
-        // send JOINREQ message to introducer member
-        emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, msgsize);
-
-        free(msg);
+        joining = true;
+        joinChunks.clear();
+        joinMissing = 0;
+        sendJoinReq(joinaddr, 0);
     }
     log->logNodeAdd(&memberNode->addr,&memberNode->addr);
 
@@ -158,6 +176,86 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 
 }
 
+/**
+ * FUNCTION NAME: sendJoinReq
+ *
+ * DESCRIPTION: Ask the introducer for its member list, from JOINREP chunk resume on
+ */
+void MP1Node::sendJoinReq(Address *joinaddr, int resume) {
+    size_t msgsize = sizeof(MessageHdr) + sizeof(joinaddr->addr) + 1 + sizeof(long) + sizeof(int);
+    MessageHdr *msg = (MessageHdr *) emulNet->ENalloc(msgsize);
+
+    // create JOINREQ message: format of data is {struct Address myaddr, pad, long heartbeat, int resume}
+    msg->msgType = JOINREQ;
+    memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
+    memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr), &memberNode->heartbeat, sizeof(long));
+    memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr) + sizeof(long), &resume, sizeof(int));
+
+    // send JOINREQ message to introducer member
+    emulNet->ENsendBuffer(&memberNode->addr, joinaddr, (char *)msg);
+    joinAsked = par->getcurrtime();
+}
+
+/**
+ * FUNCTION NAME: recvJoinRep
+ *
+ * DESCRIPTION: Merge one chunk of the introducer's member list.
+ * 				The first chunk puts this node in the group; the others keep coming in
+ * 				while it already gossips, and a chunk lost on the way is asked for
+ * 				again by nodeLoop. Chunks are cut from the list as it stood when each
+ * 				was sent, so if the chunk count changes the earlier ones are counted
+ * 				again from scratch: what they carried stays merged.
+ */
+void MP1Node::recvJoinRep(char *data, int size) {
+    char *chunkAt = data + sizeof(MessageHdr) + sizeof(Address) + 1;
+    int chunk, chunks;
+
+    if (!joining || size < (int)(sizeof(MessageHdr) + sizeof(Address) + 1 + 2 * sizeof(int))) {
+        return;
+    }
+    memcpy(&chunk, chunkAt, sizeof(int));
+    memcpy(&chunks, chunkAt + sizeof(int), sizeof(int));
+    if (chunks <= 0 || chunk < 0 || chunk >= chunks) {
+        return;
+    }
+    if ((int)joinChunks.size() != chunks) {
+        joinChunks.assign(chunks, false);
+        joinMissing = chunks;
+    }
+    if (!joinChunks[chunk]) {
+        joinChunks[chunk] = true;
+        joinMissing--;
+    }
+
+    vector<MemberListEntry> entries = deserializeMemberList(data, size);
+    for (unsigned int i = 0; i < entries.size(); i++) {
+        MemberListEntry &entry = entries[i];
+        if (entry.getid() == getid()) {
+            continue;
+        }
+        int slot = memberNode->findMember(entry.getid());
+        if (slot >= 0) {
+            if (entry.getheartbeat() > memberNode->memberList[slot].getheartbeat()) {
+                memberNode->memberList[slot] = entry;
+                markChanged(entry.getid());
+            }
+            continue;
+        }
+        memberNode->addMember(entry);
+        markChanged(entry.getid());
+        watch(entry.getid());
+
+        Address t = addressOf(entry.getid(), entry.getport());
+        log->logNodeAdd(&memberNode->addr, &t);
+    }
+
+    memberNode->inGroup = true;
+    joinAsked = par->getcurrtime();
+    if (joinMissing == 0) {
+        joining = false;
+    }
+}
+
 /**
  * FUNCTION NAME: finishUpThisNode
  *
@@ -183,6 +281,16 @@ void MP1Node::nodeLoop() {
     // Check my messages
     checkMessages();
 
+    // ask again for the JOINREP chunks that have not come, from the first one missing
+    if (joining && par->getcurrtime() - joinAsked >= JOIN_RETRY) {
+        Address joinaddr = getJoinAddress();
+        int resume = 0;
+        while (resume < (int)joinChunks.size() && joinChunks[resume]) {
+            resume++;
+        }
+        sendJoinReq(&joinaddr, resume < (int)joinChunks.size() ? resume : 0);
+    }
+
     // Wait until you're in the group...
     if( !memberNode->inGroup ) {
     	return;
@@ -209,7 +317,7 @@ void MP1Node::checkMessages() {
     	size = memberNode->mp1q.front().size;
     	memberNode->mp1q.pop();
     	recvCallBack((void *)memberNode, (char *)ptr, size);
-
+    	emulNet->ENfree((char *)ptr);
     }
     return;
 }
@@ -225,62 +333,60 @@ bool MP1Node::recvCallBack(void *env, char *data, int size ) {
     MsgTypes type = ((MessageHdr*)data)->msgType;
     
     if (type == JOINREQ) {
-        // send back a JOINREP
-        MessageHdr *msg;
-        size_t msgsize = sizeof(MessageHdr) + sizeof(Address) + sizeof(MemberListEntry) * (memberNode->memberList).size() + 1;
-        msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-
-        msg->msgType = JOINREP;
-        memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-        memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr),serializeMemberList(), sizeof(MemberListEntry) * (memberNode->memberList).size());
-        emulNet->ENsend(&memberNode->addr, sender, (char *)msg, msgsize);
+        // send back the member list as JOINREP chunks, from the one the joiner asks for
+        size_t resumeAt = sizeof(MessageHdr) + sizeof(Address) + 1 + sizeof(long);
+        vector< vector<MemberListEntry> > chunks = chunkMemberList(memberNode->memberList);
+        int resume = 0;
+        if (size >= (int)(resumeAt + sizeof(int))) {
+            memcpy(&resume, data + resumeAt, sizeof(int));
+        }
+        if (resume < 0 || resume >= (int)chunks.size()) {
+            resume = 0;
+        }
+        for (int c = resume; c < (int)chunks.size(); c++) {
+            MessageHdr *msg = newListMsg(JOINREP, chunks[c], c, chunks.size());
+            emulNet->ENsendBuffer(&memberNode->addr, sender, (char *)msg);
+        }
 
         // node exists 
-        bool flag = false;
-        for (int i = 0; i < memberNode->memberList.size(); i++) {
-            if ((memberNode->memberList)[i].getid() == *(int *)(sender->addr)) {
-                (memberNode->memberList)[i].settimestamp(par->getcurrtime());
-                (memberNode->memberList)[i].setheartbeat(*(long *)(data + sizeof(MessageHdr) + 1 + sizeof(Address)));
-                (memberNode->memberList)[i].setport(*(short *)(sender->addr + 4));
-
-                flag = true;
-                break;
-            }
+        int slot = memberNode->findMember(*(int *)(sender->addr));
+        if (slot >= 0) {
+            (memberNode->memberList)[slot].settimestamp(par->getcurrtime());
+            (memberNode->memberList)[slot].setheartbeat(*(long *)(data + sizeof(MessageHdr) + 1 + sizeof(Address)));
+            (memberNode->memberList)[slot].setport(*(short *)(sender->addr + 4));
+            markChanged(*(int *)(sender->addr));
         }
 
         // add a new entry
-        if (!flag) {
+        else {
             MemberListEntry entry;
             entry.setid(*(int *)(sender->addr));
             entry.setport(*(short *)(sender->addr + 4));
             entry.setheartbeat(*(long *)(data + sizeof(MessageHdr) + 1 + sizeof(Address)));
             entry.settimestamp(par->getcurrtime());
 
-            memberNode->memberList.push_back(entry);
-
+            memberNode->addMember(entry);
+            markChanged(entry.getid());
+            watch(entry.getid());
 
             log->logNodeAdd(&memberNode->addr,sender);
         }
+        if (par->MEMBERSHIP == MEMBERSHIP_SWIM) {
+            MemberListEntry &joined = memberNode->memberList[memberNode->findMember(*(int *)(sender->addr))];
+            dead.erase(joined.getid());
+            swimQueue(SWIM_ALIVE, joined.getid(), joined.getport(), joined.getheartbeat());
+        }
         
         free(sender);
-        free(msg);
 
     }else if (type == JOINREP) {
-        // init memberShipList coming from introducer
-        memberNode->memberList = deserializeMemberList(data,size);
-        memberNode->inGroup = true;
-
-        for (int i = 0; i < memberNode->memberList.size(); i++) {
-            Address *t = (Address*)malloc(sizeof(Address));
-            int id = memberNode->memberList[i].getid();
-            short port = memberNode->memberList[i].getport(); 
-            memcpy(t,&id,sizeof(int));
-            memcpy((char*)t + sizeof(int),&port,sizeof(short));
-            
-            log->logNodeAdd(&memberNode->addr,t);
+        // a chunk of the memberShipList coming from introducer
+        recvJoinRep(data, size);
+        free(sender);
 
-            free(t);
-        }
+    }else if (type == PING || type == ACK || type == PINGREQ) {
+        swimRecv(type, sender, data, size);
+        free(sender);
 
     }else if (type == GOSSIP) {
         // update my membership list
@@ -292,22 +398,19 @@ bool MP1Node::recvCallBack(void *env, char *data, int size ) {
                 continue;
             }
             
-            bool exist = false;
-            for (int j = 0; j < memberNode->memberList.size(); j++) {
-                // next: update old member list
-                MemberListEntry oldEntry = memberNode->memberList[j];
-                if (newEntry.getid() == oldEntry.getid()) {
-                    if (newEntry.getheartbeat() > oldEntry.getheartbeat()) {
-                        memberNode->memberList[j] = newEntry;
-                    }
-
-                    exist = true;
-                    break;
+            // next: update old member list
+            int j = memberNode->findMember(newEntry.getid());
+            if (j >= 0) {
+                if (newEntry.getheartbeat() > memberNode->memberList[j].getheartbeat()) {
+                    memberNode->memberList[j] = newEntry;
+                    markChanged(newEntry.getid());
                 }
             }
-
-            if (!exist && par->getcurrtime() - newEntry.gettimestamp() < par->EN_GPSZ * 2) {
-                memberNode->memberList.push_back(newEntry);
+            else if (par->getcurrtime() - newEntry.gettimestamp() < par->EN_GPSZ * 2 && !removedAt(newEntry)) {
+                dead.erase(newEntry.getid());
+                memberNode->addMember(newEntry);
+                markChanged(newEntry.getid());
+                watch(newEntry.getid());
 
                 Address *t = (Address*)malloc(sizeof(Address));
                 int id = newEntry.getid();
@@ -329,9 +432,17 @@ bool MP1Node::recvCallBack(void *env, char *data, int size ) {
  */
 vector<MemberListEntry> MP1Node::deserializeMemberList(char *data, int size) {
     int offset = sizeof(MessageHdr) + sizeof(Address) + 1;
+    if (size >= offset && ((MessageHdr *)data)->msgType == JOINREP) {
+        // skip the chunk number and count
+        offset += 2 * sizeof(int);
+    }
     int memberSize = size - offset;
     vector<MemberListEntry> rt;
 
+    if (memberSize >= 0 && data[sizeof(MessageHdr) + sizeof(Address)] == WIRE_PACKED) {
+        return unpackMemberList(data + offset, memberSize);
+    }
+
     while (memberSize > 0) {
         MemberListEntry *entry = (MemberListEntry *)(data + offset);
         rt.push_back(*entry);
@@ -344,43 +455,394 @@ vector<MemberListEntry> MP1Node::deserializeMemberList(char *data, int size) {
 }
 
 /*
- * deserilize membership vector to array
+ * serialize membership vector into the array at buffer
  */
-char* MP1Node::serializeMemberList() {
-    size_t size = sizeof(MemberListEntry) * memberNode->memberList.size();
-    MemberListEntry *rt = (MemberListEntry *)malloc(size * sizeof(char));
+void MP1Node::serializeMemberList(char *buffer, vector<MemberListEntry> &entries) {
+    MemberListEntry *rt = (MemberListEntry *)buffer;
 
-    for (int i = 0; i < memberNode->memberList.size(); i++) {
-        memcpy( (char *)(rt + i), &memberNode->memberList[i], sizeof(MemberListEntry) );
+    for (unsigned int i = 0; i < entries.size(); i++) {
+        memcpy( (char *)(rt + i), &entries[i], sizeof(MemberListEntry) );
     }
+}
 
-    return (char*)rt;
+/*
+ * append v to out as a varint, 7 bits per byte, low bits first
+ */
+static void putVarint(string &out, unsigned long v) {
+    while (v >= 0x80) {
+        out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
 }
 
-int MP1Node::getid() {
-    return *(int *)memberNode->addr.addr;
+/*
+ * read a varint at data[*pos], false if it runs past size
+ */
+static bool getVarint(char *data, int size, int *pos, unsigned long *v) {
+    *v = 0;
+    for (int shift = 0; *pos < size && shift < 64; shift += 7) {
+        unsigned char b = data[(*pos)++];
+        *v |= (unsigned long)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-void MP1Node::randomPickAndGossip() {
-    Address *toaddr = (Address *)malloc(sizeof(Address));
-    int ranID = rand() % memberNode->memberList.size();
+// signed values as varints: 0, -1, 1, -2, ... map to 0, 1, 2, 3, ...
+static unsigned long zigzag(long v) {
+    return ((unsigned long)v << 1) ^ (unsigned long)(v >> 63);
+}
 
-    int id = (memberNode->memberList[ranID]).getid();
-    short port = (memberNode->memberList[ranID]).getport(); // pick the first element, for now
-    memcpy(toaddr,&id,sizeof(int));
-    memcpy((char*)toaddr + sizeof(int),&port,sizeof(short));
-    
+static long unzigzag(unsigned long v) {
+    return (long)(v >> 1) ^ -(long)(v & 1);
+}
+
+static bool entryIdLess(const MemberListEntry &a, const MemberListEntry &b) {
+    return a.id < b.id;
+}
+
+/*
+ * pack membership vector: varint base time and count, then per entry, in id order,
+ * the varint gap from the previous id, the 16-bit port, the zigzag change of heartbeat
+ * from the previous entry and the zigzag age of its timestamp at the base time
+ */
+static void packEntry(string &out, MemberListEntry &e, int &id, long &heartbeat, long now) {
+    putVarint(out, e.getid() - id);
+    out += (char)(e.getport() & 0xff);
+    out += (char)((e.getport() >> 8) & 0xff);
+    putVarint(out, zigzag(e.getheartbeat() - heartbeat));
+    putVarint(out, zigzag(now - e.gettimestamp()));
+    id = e.getid();
+    heartbeat = e.getheartbeat();
+}
+
+string MP1Node::packMemberList(vector<MemberListEntry> &entries) {
+    vector<MemberListEntry> sorted(entries);
+    long now = par->getcurrtime();
+    long heartbeat = 0;
+    int id = 0;
+    string out;
+
+    sort(sorted.begin(), sorted.end(), entryIdLess);
+    putVarint(out, now);
+    putVarint(out, sorted.size());
+    for (unsigned int i = 0; i < sorted.size(); i++) {
+        packEntry(out, sorted[i], id, heartbeat, now);
+    }
+    return out;
+}
+
+/*
+ * split membership vector into JOINREP chunks that each fit in one message of the
+ * configured MEMBER_CODEC, at least one chunk even for an empty list
+ */
+vector< vector<MemberListEntry> > MP1Node::chunkMemberList(vector<MemberListEntry> &entries) {
+    // what is left of MAX_MSG_SIZE after the network's envelope, the JOINREP header
+    // and the two varints in front of a packed list
+    int room = par->MAX_MSG_SIZE - 1 - sizeof(en_msg) - (sizeof(MessageHdr) + sizeof(Address) + 1 + 2 * sizeof(int)) - 20;
+    vector< vector<MemberListEntry> > chunks(1);
+
+    if (par->MEMBER_CODEC != CODEC_PACKED) {
+        unsigned int per = max(1, room / (int)sizeof(MemberListEntry));
+        for (unsigned int i = 0; i < entries.size(); i++) {
+            if (chunks.back().size() == per) {
+                chunks.push_back(vector<MemberListEntry>());
+            }
+            chunks.back().push_back(entries[i]);
+        }
+        return chunks;
+    }
+
+    // packed entries are deltas, so measure each one as packMemberList will write it
+    vector<MemberListEntry> sorted(entries);
+    long now = par->getcurrtime();
+    long heartbeat = 0;
+    int id = 0;
+    int used = 0;
+    string piece;
+
+    sort(sorted.begin(), sorted.end(), entryIdLess);
+    for (unsigned int i = 0; i < sorted.size(); i++) {
+        piece.clear();
+        packEntry(piece, sorted[i], id, heartbeat, now);
+        if (used + (int)piece.size() > room && !chunks.back().empty()) {
+            // a new chunk starts its deltas from zero again
+            chunks.push_back(vector<MemberListEntry>());
+            used = 0;
+            id = 0;
+            heartbeat = 0;
+            piece.clear();
+            packEntry(piece, sorted[i], id, heartbeat, now);
+        }
+        used += piece.size();
+        chunks.back().push_back(sorted[i]);
+    }
+    return chunks;
+}
+
+/*
+ * unpack a membership vector written by packMemberList, stopping at the first damaged entry
+ */
+vector<MemberListEntry> MP1Node::unpackMemberList(char *data, int size) {
+    vector<MemberListEntry> rt;
+    unsigned long now, count, gap, hb, age;
+    long heartbeat = 0;
+    int id = 0;
+    int pos = 0;
+
+    if (!getVarint(data, size, &pos, &now) || !getVarint(data, size, &pos, &count)) {
+        return rt;
+    }
+    for (unsigned long i = 0; i < count; i++) {
+        if (!getVarint(data, size, &pos, &gap) || pos + 2 > size) {
+            break;
+        }
+        short port = (short)((unsigned char)data[pos] | ((unsigned char)data[pos + 1] << 8));
+        pos += 2;
+        if (!getVarint(data, size, &pos, &hb) || !getVarint(data, size, &pos, &age)) {
+            break;
+        }
+        id += gap;
+        heartbeat += unzigzag(hb);
+        rt.push_back(MemberListEntry(id, port, heartbeat, (long)now - unzigzag(age)));
+    }
+    return rt;
+}
+
+/*
+ * JOINREP or GOSSIP message carrying entries in the configured MEMBER_CODEC.
+ * A JOINREP also carries chunk and chunks, its place in the whole list, after the codec byte.
+ */
+MessageHdr *MP1Node::newListMsg(MsgTypes type, vector<MemberListEntry> &entries, int chunk, int chunks) {
     MessageHdr *msg;
-    size_t msgsize = sizeof(MessageHdr) + sizeof(Address) + sizeof(MemberListEntry) * memberNode->memberList.size() + 1;
-    msg = (MessageHdr *) malloc(msgsize * sizeof(char));
-    msg->msgType = GOSSIP;
+    char *list;
+    string packed;
+    size_t header = sizeof(MessageHdr) + sizeof(Address) + 1 + (type == JOINREP ? 2 * sizeof(int) : 0);
+    size_t msgsize = header;
+
+    if (par->MEMBER_CODEC == CODEC_PACKED) {
+        packed = packMemberList(entries);
+        msgsize += packed.size();
+    }
+    else {
+        msgsize += sizeof(MemberListEntry) * entries.size();
+    }
+    msg = (MessageHdr *) emulNet->ENalloc(msgsize);
+    msg->msgType = type;
     memcpy((char *)(msg+1), &memberNode->addr.addr, sizeof(memberNode->addr.addr));
-    memcpy((char *)(msg+1) + 1 + sizeof(memberNode->addr.addr),serializeMemberList(), sizeof(MemberListEntry) * (memberNode->memberList).size());
-    
-    emulNet->ENsend(&memberNode->addr, toaddr, (char *)msg, msgsize);
+    list = (char *)msg + header;
+    if (type == JOINREP) {
+        memcpy(list - 2 * sizeof(int), &chunk, sizeof(int));
+        memcpy(list - sizeof(int), &chunks, sizeof(int));
+    }
+    if (par->MEMBER_CODEC == CODEC_PACKED) {
+        ((char *)(msg+1))[sizeof(Address)] = WIRE_PACKED;
+        memcpy(list, packed.data(), packed.size());
+    }
+    else {
+        ((char *)(msg+1))[sizeof(Address)] = WIRE_RAW;
+        serializeMemberList(list, entries);
+    }
+    return msg;
+}
+
+int MP1Node::getid() {
+    return *(int *)memberNode->addr.addr;
+}
+
+/**
+ * FUNCTION NAME: markChanged
+ *
+ * DESCRIPTION: Note that the entry of member id changed this tick, so delta gossip carries it.
+ * 				For the phi accrual detector this is a heartbeat arrival: the gap since
+ * 				the previous one goes into the member's window of inter-arrival times.
+ */
+void MP1Node::markChanged(int id) {
+    int now = par->getcurrtime();
+
+    if (par->GOSSIP_MODE == GOSSIP_DELTA) {
+        changedAt[id] = now;
+    }
+    if (par->FAILURE_DETECTOR == DETECTOR_PHI) {
+        arrivalWindow &w = arrivals[id];
+        if (w.last >= 0 && now > w.last) {
+            int gap = now - w.last;
+            if ((int)w.gaps.size() < par->PHI_WINDOW) {
+                w.gaps.push_back(gap);
+            }
+            else {
+                w.sum -= w.gaps[w.next];
+                w.sumsq -= (double)w.gaps[w.next] * w.gaps[w.next];
+                w.gaps[w.next] = gap;
+                w.next = (w.next + 1) % par->PHI_WINDOW;
+            }
+            w.sum += gap;
+            w.sumsq += (double)gap * gap;
+        }
+        w.last = now;
+    }
+}
+
+/**
+ * FUNCTION NAME: phiSigmas
+ *
+ * DESCRIPTION: Standard deviations past the mean gap at which phi reaches threshold.
+ * 				phi = -log10(1 - F(y)) with F the logistic approximation of the normal
+ * 				CDF, F(y) = 1 / (1 + e^-(y (1.5976 + 0.070566 y^2))), so the crossing is
+ * 				the root of y (1.5976 + 0.070566 y^2) = ln((1 - p) / p), p = 10^-threshold.
+ * 				Computed once; a member's deadline is then a multiply and an add.
+ */
+double MP1Node::phiSigmas(double threshold) {
+    double p = pow(10.0, -threshold);
+    double target = ::log((1 - p) / p);
+    double y = target / 1.5976;
+    // the left side is increasing and convex for y > 0, Newton converges from above
+    for (int i = 0; i < 50; i++) {
+        double f = y * (1.5976 + 0.070566 * y * y) - target;
+        double df = 1.5976 + 3 * 0.070566 * y * y;
+        y -= f / df;
+        if (fabs(f) < 1e-9) {
+            break;
+        }
+    }
+    return y;
+}
+
+/**
+ * FUNCTION NAME: deadlineOf
+ *
+ * DESCRIPTION: Tick at which the member at slot is declared failed.
+ * 				The fixed detector allows EN_GPSZ * 2 + 10 ticks past its timestamp. The
+ * 				phi accrual detector waits until phi of the gap since the last heartbeat
+ * 				arrival reaches PHI_THRESHOLD, falling back to the fixed rule until it has
+ * 				seen PHI_MIN_SAMPLES gaps of that member.
+ */
+long MP1Node::deadlineOf(int slot) {
+    MemberListEntry &entry = memberNode->memberList[slot];
+    long fixed = entry.gettimestamp() + par->EN_GPSZ * 2 + 11;
+
+    if (par->FAILURE_DETECTOR != DETECTOR_PHI) {
+        return fixed;
+    }
+    unordered_map<int, arrivalWindow>::iterator it = arrivals.find(entry.getid());
+    if (it == arrivals.end() || (int)it->second.gaps.size() < par->PHI_MIN_SAMPLES) {
+        return fixed;
+    }
+    arrivalWindow &w = it->second;
+    double n = w.gaps.size();
+    double mean = w.sum / n;
+    double stddev = max(par->PHI_MIN_STDDEV, sqrt(max(0.0, w.sumsq / n - mean * mean)));
+    return w.last + (long)ceil(mean + phiSigma * stddev);
+}
+
+/**
+ * FUNCTION NAME: removedAt
+ *
+ * DESCRIPTION: Whether entry is no newer than when we removed its member. A member removed
+ * 				early by the phi detector is otherwise put straight back by gossip from nodes
+ * 				that have not timed it out yet; a live one comes back with its next heartbeat.
+ * 				The fixed detector keeps gossip's original behaviour and never says so.
+ */
+bool MP1Node::removedAt(MemberListEntry &entry) {
+    if (par->FAILURE_DETECTOR != DETECTOR_PHI) {
+        return false;
+    }
+    unordered_map<int, long>::iterator gone = dead.find(entry.getid());
+    return gone != dead.end() && entry.getheartbeat() <= gone->second;
+}
+
+/**
+ * FUNCTION NAME: watch
+ *
+ * DESCRIPTION: Set the failure timer of member id to its deadline.
+ * 				A member has at most one timer; heartbeats do not touch it, a timer that
+ * 				runs out on a refreshed member is just set again from its new deadline.
+ */
+void MP1Node::watch(int id) {
+    int slot = memberNode->findMember(id);
+    if (par->MEMBERSHIP != MEMBERSHIP_GOSSIP || id == getid() || slot < 0 || !watched.insert(id).second) {
+        return;
+    }
+    expiry.schedule(max(deadlineOf(slot), expiry.getNow() + 1), id);
+}
+
+/**
+ * FUNCTION NAME: gossipEntries
+ *
+ * DESCRIPTION: Entries of the membership list to gossip in a round.
+ * 				In delta mode only the ones that changed after tick since, plus our own.
+ * 				Heartbeats move every tick and a peer is picked again only every ~N/k
+ * 				rounds, so a window per peer would hold nearly the whole list; since is
+ * 				the tick of our GOSSIP_RETRANSMIT-th previous round, so each change is
+ * 				passed on for that many rounds. since -1 gives the whole list.
+ * 				The whole list is the membership list itself, not a copy; a delta is
+ * 				gathered in a vector kept across rounds.
+ */
+vector<MemberListEntry> &MP1Node::gossipEntries(int since) {
+    if (par->GOSSIP_MODE != GOSSIP_DELTA || since < 0) {
+        return memberNode->memberList;
+    }
+
+    changed.clear();
+    for (unsigned int i = 0; i < memberNode->memberList.size(); i++) {
+        MemberListEntry &entry = memberNode->memberList[i];
+        if (entry.getid() == getid()) {
+            changed.push_back(entry);
+            continue;
+        }
+        unordered_map<int, int>::iterator at = changedAt.find(entry.getid());
+        if (at != changedAt.end() && at->second > since) {
+            changed.push_back(entry);
+        }
+    }
+    return changed;
+}
+
+/**
+ * FUNCTION NAME: randomPickAndGossip
+ *
+ * DESCRIPTION: Gossip to GOSSIP_FANOUT members other than ourselves, sampled without
+ * 				replacement by a partial Fisher-Yates shuffle of the member slots.
+ * 				They share one message, except in delta mode a peer we have not
+ * 				gossiped to before, which gets the whole list on its own; every
+ * 				GOSSIP_DIGEST-th round the shared message is the whole list too,
+ * 				which repairs lost deltas.
+ */
+void MP1Node::randomPickAndGossip() {
+    int now = par->getcurrtime();
+    int &since = gossipTicks[++gossipRound % gossipTicks.size()];
+    bool delta = (par->GOSSIP_MODE == GOSSIP_DELTA);
+    vector<Address> shared;
+
+    peers.clear();
+    for (unsigned int i = 0; i < memberNode->memberList.size(); i++) {
+        if (memberNode->memberList[i].getid() != getid()) {
+            peers.push_back(i);
+        }
+    }
+    int fanout = min(par->GOSSIP_FANOUT, (int)peers.size());
+    for (int i = 0; i < fanout; i++) {
+        swap(peers[i], peers[i + rng.nextInt(peers.size() - i)]);
+
+        MemberListEntry &peer = memberNode->memberList[peers[i]];
+        Address toaddr = addressOf(peer.getid(), peer.getport());
+        if (delta && gossipedTo.insert(peer.getid()).second) {
+            MessageHdr *msg = newListMsg(GOSSIP, memberNode->memberList, 0, 1);
+            emulNet->ENsendBuffer(&memberNode->addr, &toaddr, (char *)msg);
+        }
+        else {
+            shared.push_back(toaddr);
+        }
+    }
 
-    free(toaddr);
-    free(msg);
+    if (!shared.empty()) {
+        MessageHdr *msg = newListMsg(GOSSIP, gossipEntries(gossipRound % par->GOSSIP_DIGEST == 0 ? -1 : since), 0, 1);
+        emulNet->ENsendMulti(&memberNode->addr, &shared[0], shared.size(), (char *)msg, -1, NULL, NULL);
+    }
+    since = now;
 }
 
 /**
@@ -391,40 +853,64 @@ void MP1Node::randomPickAndGossip() {
  * 				Propagate your membership list
  */
 void MP1Node::nodeLoopOps() {
-    // remove dead node
-    for (int i = 0; i < memberNode->memberList.size(); i++) {
-        MemberListEntry entry = memberNode->memberList[i];
-        if (entry.getid() == *(int *)(&memberNode->addr)) {
-            memberNode->memberList.erase(memberNode->memberList.begin() + i);
-            i--;
+    if (par->MEMBERSHIP == MEMBERSHIP_SWIM) {
+        swimLoopOps();
+        return;
+    }
+
+    // remove dead node: only the members whose timer ran out are looked at
+    vector<int> expired;
+    expiry.advance(par->getcurrtime(), expired);
+    for (unsigned int i = 0; i < expired.size(); i++) {
+        int id = expired[i];
+        int slot = memberNode->findMember(id);
+        watched.erase(id);
+        if (slot < 0) {
+            continue;
         }
 
-        if ( par->EN_GPSZ * 2 + 10 < par->getcurrtime() - memberNode->memberList[i].gettimestamp()) {
+        if (par->getcurrtime() >= deadlineOf(slot)) {
           
             Address *toaddr = (Address *)malloc(sizeof(Address));
-            int id = (memberNode->memberList[i]).getid();
-            short port = (memberNode->memberList[i]).getport(); // pick the first element, for now
+            short port = (memberNode->memberList[slot]).getport(); // pick the first element, for now
             memcpy(toaddr,&id,sizeof(int));
             memcpy((char*)toaddr + sizeof(int),&port,sizeof(short));
 
             log->logNodeRemove(&memberNode->addr,toaddr);
             
             free(toaddr);
+            changedAt.erase(id);
+            gossipedTo.erase(id);
+            arrivals.erase(id);
+            if (par->FAILURE_DETECTOR == DETECTOR_PHI) {
+                dead[id] = memberNode->memberList[slot].getheartbeat();
+            }
+            removals.push_back(make_pair(id, par->getcurrtime()));
 
-            memberNode->memberList.erase(memberNode->memberList.begin() + i);
-            i--;
+            memberNode->removeMemberAt(slot);
+        }
+        else {
+            // refreshed since the timer was set
+            watch(id);
         }
     }
 
-    // increment heartbeat and add to list
+    // increment heartbeat and refresh my own entry
     memberNode->heartbeat++;
 
-    MemberListEntry entry;
-    entry.setid(*(int *)(memberNode->addr.addr));
-    entry.setport(*(short*)(memberNode->addr.addr + 4));
-    entry.setheartbeat(memberNode->heartbeat);
-    entry.settimestamp(par->getcurrtime());
-    memberNode->memberList.push_back(entry);
+    int self = memberNode->findMember(getid());
+    if (self >= 0) {
+        memberNode->memberList[self].setheartbeat(memberNode->heartbeat);
+        memberNode->memberList[self].settimestamp(par->getcurrtime());
+    }
+    else {
+        MemberListEntry entry;
+        entry.setid(*(int *)(memberNode->addr.addr));
+        entry.setport(*(short*)(memberNode->addr.addr + 4));
+        entry.setheartbeat(memberNode->heartbeat);
+        entry.settimestamp(par->getcurrtime());
+        memberNode->addMember(entry);
+    }
     // pick a neighbor randomly and gossip
     randomPickAndGossip();
 
@@ -433,6 +919,333 @@ void MP1Node::nodeLoopOps() {
 
 
 
+/**
+ * FUNCTION NAME: addressOf
+ *
+ * DESCRIPTION: Address of the member with the given id and port
+ */
+Address MP1Node::addressOf(int id, short port) {
+    Address addr;
+    memcpy(&addr.addr[0], &id, sizeof(int));
+    memcpy(&addr.addr[4], &port, sizeof(short));
+    return addr;
+}
+
+/**
+ * FUNCTION NAME: swimLoopOps
+ *
+ * DESCRIPTION: SWIM protocol duties of one tick.
+ * 				Every SWIM_PERIOD ticks one member is pinged, in a shuffled round so each
+ * 				is probed within two rounds. Without an ACK after SWIM_TIMEOUT ticks SWIM_K
+ * 				other members are asked to ping it too; without any ACK by the end of the
+ * 				period it becomes suspect, and a suspect that does not refute within
+ * 				SWIM_SUSPECT periods is removed. Membership updates travel piggybacked on
+ * 				the probe messages, so a node sends O(1) messages per period whatever
+ * 				the size of the group.
+ */
+void MP1Node::swimLoopOps() {
+    int now = par->getcurrtime();
+
+    // our own entry stays in the table for MP2; announcing it covers the introducer,
+    // which is not in the list it hands out to the first joiners
+    if (memberNode->findMember(getid()) < 0) {
+        short port = *(short *)(memberNode->addr.addr + 4);
+        memberNode->addMember(MemberListEntry(getid(), port, memberNode->heartbeat, now));
+        swimQueue(SWIM_ALIVE, getid(), port, memberNode->heartbeat);
+    }
+
+    if (probeTarget >= 0 && !probeAcked && !probeIndirect && now >= probeStart + par->SWIM_TIMEOUT) {
+        int target = memberNode->findMember(probeTarget);
+        vector<int> helpers;
+        for (unsigned int i = 0; i < memberNode->memberList.size(); i++) {
+            int id = memberNode->memberList[i].getid();
+            if (id != getid() && id != probeTarget) {
+                helpers.push_back(i);
+            }
+        }
+        probeIndirect = true;
+        if (target >= 0) {
+            Address targetAddr = addressOf(probeTarget, memberNode->memberList[target].getport());
+            // partial Fisher-Yates: the first SWIM_K slots end up a uniform sample
+            for (int k = 0; k < par->SWIM_K && k < (int)helpers.size(); k++) {
+                swap(helpers[k], helpers[k + rng.nextInt(helpers.size() - k)]);
+                MemberListEntry &helper = memberNode->memberList[helpers[k]];
+                Address helperAddr = addressOf(helper.getid(), helper.getport());
+                swimSend(PINGREQ, &helperAddr, probeSeq, &targetAddr);
+            }
+        }
+    }
+
+    if (now >= probeStart + par->SWIM_PERIOD) {
+        if (probeTarget >= 0 && !probeAcked) {
+            int target = memberNode->findMember(probeTarget);
+            if (target >= 0) {
+                swimSuspect(target);
+            }
+        }
+        swimProbe();
+    }
+
+    // suspects that did not refute in time are confirmed dead
+    for (map<int, int>::iterator it = suspects.begin(); it != suspects.end(); ) {
+        int id = it->first;
+        int since = it->second;
+        ++it;
+        if (now - since >= par->SWIM_SUSPECT * par->SWIM_PERIOD) {
+            int slot = memberNode->findMember(id);
+            swimApply(SWIM_CONFIRM, id, slot >= 0 ? memberNode->memberList[slot].getport() : 0,
+                      slot >= 0 ? memberNode->memberList[slot].getheartbeat() : 0);
+        }
+    }
+
+    for (map<int, swimRelay>::iterator it = relays.begin(); it != relays.end(); ) {
+        if (it->second.expires <= now) {
+            it = relays.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: swimProbe
+ *
+ * DESCRIPTION: Start the probe of the next member in the round, reshuffling when it is done
+ */
+void MP1Node::swimProbe() {
+    probeTarget = -1;
+    probeAcked = false;
+    probeIndirect = false;
+    probeStart = par->getcurrtime();
+
+    for (int pass = 0; pass < 2 && probeTarget < 0; pass++) {
+        if (probeNext >= probeOrder.size()) {
+            probeOrder.clear();
+            for (unsigned int i = 0; i < memberNode->memberList.size(); i++) {
+                if (memberNode->memberList[i].getid() != getid()) {
+                    probeOrder.push_back(memberNode->memberList[i].getid());
+                }
+            }
+            for (int i = (int)probeOrder.size() - 1; i > 0; i--) {
+                swap(probeOrder[i], probeOrder[rng.nextInt(i + 1)]);
+            }
+            probeNext = 0;
+        }
+        // members removed since the round was drawn are skipped
+        while (probeNext < probeOrder.size() && probeTarget < 0) {
+            int id = probeOrder[probeNext++];
+            if (memberNode->findMember(id) >= 0) {
+                probeTarget = id;
+            }
+        }
+    }
+    if (probeTarget < 0) {
+        return;
+    }
+
+    MemberListEntry &target = memberNode->memberList[memberNode->findMember(probeTarget)];
+    Address targetAddr = addressOf(probeTarget, target.getport());
+    probeSeq = nextSeq++;
+    swimSend(PING, &targetAddr, probeSeq, &targetAddr);
+}
+
+/**
+ * FUNCTION NAME: swimSuspect
+ *
+ * DESCRIPTION: Start suspecting the member at slot of the membership table
+ */
+void MP1Node::swimSuspect(int slot) {
+    MemberListEntry &entry = memberNode->memberList[slot];
+    swimApply(SWIM_SUSPECT, entry.getid(), entry.getport(), entry.getheartbeat());
+}
+
+/**
+ * FUNCTION NAME: swimSend
+ *
+ * DESCRIPTION: Send a PING, ACK or PINGREQ with as many pending updates as fit.
+ * 				Layout after the sender's address and the wire byte: int seq, the address
+ * 				of the probed member, a count byte and the updates. Updates that went out
+ * 				least often go first; each is sent 3 log2(N) times in all.
+ */
+void MP1Node::swimSend(MsgTypes type, Address *to, int seq, Address *target) {
+    vector<pair<int, int> > order;
+    for (map<int, swimUpdate>::iterator it = updates.begin(); it != updates.end(); ++it) {
+        order.push_back(make_pair(it->second.sent, it->first));
+    }
+    sort(order.begin(), order.end());
+    int count = min((int)order.size(), SWIM_PIGGYBACK);
+    int limit = 3 * (int)ceil(log2(memberNode->memberList.size() + 1));
+
+    size_t msgsize = sizeof(MessageHdr) + sizeof(Address) + 1 + sizeof(int) + sizeof(Address) + 1 + count * SWIM_UPDATE_SIZE;
+    MessageHdr *msg = (MessageHdr *) emulNet->ENalloc(msgsize);
+    char *p = (char *)(msg+1);
+    msg->msgType = type;
+    memcpy(p, &memberNode->addr.addr, sizeof(memberNode->addr.addr));
+    p += sizeof(memberNode->addr.addr);
+    *p++ = WIRE_RAW;
+    memcpy(p, &seq, sizeof(int));
+    p += sizeof(int);
+    memcpy(p, target->addr, sizeof(target->addr));
+    p += sizeof(target->addr);
+    *p++ = (char)count;
+
+    for (int i = 0; i < count; i++) {
+        int id = order[i].second;
+        swimUpdate &u = updates[id];
+        *p = (char)u.kind;
+        memcpy(p + 1, &id, sizeof(int));
+        memcpy(p + 5, &u.port, sizeof(short));
+        memcpy(p + 7, &u.incarnation, sizeof(long));
+        p += SWIM_UPDATE_SIZE;
+        if (++u.sent >= limit) {
+            updates.erase(id);
+        }
+    }
+
+    emulNet->ENsendBuffer(&memberNode->addr, to, (char *)msg);
+}
+
+/**
+ * FUNCTION NAME: swimRecv
+ *
+ * DESCRIPTION: Handle a PING, ACK or PINGREQ and the updates it carries
+ */
+void MP1Node::swimRecv(MsgTypes type, Address *sender, char *data, int size) {
+    int header = sizeof(MessageHdr) + sizeof(Address) + 1 + sizeof(int) + sizeof(Address) + 1;
+    if (size < header) {
+        return;
+    }
+    char *p = data + sizeof(MessageHdr) + sizeof(Address) + 1;
+    int seq;
+    Address target;
+    memcpy(&seq, p, sizeof(int));
+    memcpy(target.addr, p + sizeof(int), sizeof(target.addr));
+    int count = (unsigned char)p[sizeof(int) + sizeof(target.addr)];
+    p = data + header;
+
+    for (int i = 0; i < count && p + SWIM_UPDATE_SIZE <= data + size; i++, p += SWIM_UPDATE_SIZE) {
+        int id;
+        short port;
+        long incarnation;
+        memcpy(&id, p + 1, sizeof(int));
+        memcpy(&port, p + 5, sizeof(short));
+        memcpy(&incarnation, p + 7, sizeof(long));
+        swimApply(*p, id, port, incarnation);
+    }
+
+    if (type == PING) {
+        swimSend(ACK, sender, seq, &memberNode->addr);
+    }
+    else if (type == PINGREQ) {
+        swimRelay relay;
+        relay.requester = *sender;
+        relay.seq = seq;
+        relay.expires = par->getcurrtime() + par->SWIM_PERIOD;
+        relays[nextSeq] = relay;
+        swimSend(PING, &target, nextSeq++, &target);
+    }
+    else if (type == ACK) {
+        map<int, swimRelay>::iterator relay = relays.find(seq);
+        if (seq == probeSeq && *(int *)(target.addr) == probeTarget) {
+            probeAcked = true;
+        }
+        else if (relay != relays.end()) {
+            swimSend(ACK, &relay->second.requester, relay->second.seq, &target);
+            relays.erase(relay);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: swimQueue
+ *
+ * DESCRIPTION: Piggyback an update on the next messages, replacing older news of the member
+ */
+void MP1Node::swimQueue(int kind, int id, short port, long incarnation) {
+    swimUpdate u;
+    u.kind = kind;
+    u.port = port;
+    u.incarnation = incarnation;
+    u.sent = 0;
+    updates[id] = u;
+}
+
+/**
+ * FUNCTION NAME: swimApply
+ *
+ * DESCRIPTION: Apply a membership update, passing it on if it is news.
+ * 				Incarnations order the updates of a member: ALIVE overrides SUSPECT only
+ * 				with a higher incarnation, SUSPECT overrides ALIVE at the same one, and
+ * 				CONFIRM is final until the member comes back with a higher incarnation.
+ * 				A member told it is suspected or dead refutes with a new incarnation.
+ */
+void MP1Node::swimApply(int kind, int id, short port, long incarnation) {
+    int now = par->getcurrtime();
+    int slot = memberNode->findMember(id);
+
+    if (id == getid()) {
+        if (kind != SWIM_ALIVE && incarnation >= memberNode->heartbeat) {
+            memberNode->heartbeat = incarnation + 1;
+            if (slot >= 0) {
+                memberNode->memberList[slot].setheartbeat(memberNode->heartbeat);
+            }
+            swimQueue(SWIM_ALIVE, id, *(short *)(memberNode->addr.addr + 4), memberNode->heartbeat);
+        }
+        return;
+    }
+
+    if (kind == SWIM_ALIVE) {
+        unordered_map<int, long>::iterator gone = dead.find(id);
+        if (gone != dead.end() && incarnation <= gone->second) {
+            return;
+        }
+        if (slot < 0) {
+            Address addr = addressOf(id, port);
+            memberNode->addMember(MemberListEntry(id, port, incarnation, now));
+            dead.erase(id);
+            log->logNodeAdd(&memberNode->addr, &addr);
+        }
+        else if (incarnation > memberNode->memberList[slot].getheartbeat()) {
+            memberNode->memberList[slot].setheartbeat(incarnation);
+            memberNode->memberList[slot].settimestamp(now);
+            suspects.erase(id);
+        }
+        else {
+            return;
+        }
+        swimQueue(kind, id, port, incarnation);
+    }
+    else if (kind == SWIM_SUSPECT) {
+        if (slot < 0) {
+            return;
+        }
+        MemberListEntry &entry = memberNode->memberList[slot];
+        if (incarnation < entry.getheartbeat() || (incarnation == entry.getheartbeat() && suspects.count(id))) {
+            return;
+        }
+        entry.setheartbeat(incarnation);
+        suspects[id] = now;
+        swimQueue(kind, id, port, incarnation);
+    }
+    else if (kind == SWIM_CONFIRM) {
+        unordered_map<int, long>::iterator gone = dead.find(id);
+        if (gone == dead.end() || gone->second < incarnation) {
+            dead[id] = incarnation;
+        }
+        if (slot < 0) {
+            return;
+        }
+        short known = memberNode->memberList[slot].getport();
+        Address addr = addressOf(id, known);
+        log->logNodeRemove(&memberNode->addr, &addr);
+        memberNode->removeMemberAt(slot);
+        removals.push_back(make_pair(id, now));
+        suspects.erase(id);
+        swimQueue(kind, id, known, incarnation);
+    }
+}
+
 /**
  * FUNCTION NAME: isNullAddress
  *
@@ -463,7 +1276,7 @@ Address MP1Node::getJoinAddress() {
  * DESCRIPTION: Initialize the membership list
  */
 void MP1Node::initMemberListTable(Member *memberNode) {
-	memberNode->memberList.clear();
+	memberNode->clearMembers();
 }
 
 /**
@@ -14,6 +14,10 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "Random.h"
+#include "TimingWheel.h"
+#include <unordered_map>
+#include <unordered_set>
 
 /**
  * Macros
@@ -21,6 +25,17 @@
 #define TREMOVE 20
 #define TFAIL 5
 
+// encoding of the member list in JOINREP and GOSSIP, the byte after the sender's address
+#define WIRE_RAW 0
+#define WIRE_PACKED 1
+
+// ticks a joiner waits on a JOINREP chunk before asking the introducer again
+#define JOIN_RETRY 10
+
+// SWIM: updates piggybacked on one probe message, and the bytes each takes
+#define SWIM_PIGGYBACK 8
+#define SWIM_UPDATE_SIZE 15
+
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
  */
@@ -32,6 +47,9 @@ enum MsgTypes{
     JOINREQ,
     JOINREP,
     GOSSIP,
+    PING,
+    ACK,
+    PINGREQ,
     DUMMYLASTMSGTYPE
 };
 
@@ -44,6 +62,15 @@ typedef struct MessageHdr {
 	enum MsgTypes msgType;
 }MessageHdr;
 
+/**
+ * SWIM membership updates
+ */
+enum SwimUpdates {
+    SWIM_ALIVE,
+    SWIM_SUSPECT,
+    SWIM_CONFIRM
+};
+
 /**
  * CLASS NAME: MP1Node
  *
@@ -56,12 +83,99 @@ private:
 	Params *par;
 	Member *memberNode;
 	char NULLADDR[6];
+	// this node's own random stream
+	Random rng;
+	// delta gossip: tick at which each member's entry last changed here
+	unordered_map<int, int> changedAt;
+	// delta gossip: peers that have had a whole list from us
+	unordered_set<int> gossipedTo;
+	// gossip rounds so far, for the periodic full digest, and the ticks of the last
+	// GOSSIP_RETRANSMIT ones, by round modulo GOSSIP_RETRANSMIT
+	int gossipRound;
+	vector<int> gossipTicks;
+	// member slots to sample gossip peers from
+	vector<int> peers;
+	// delta gossip: the entries of the current round
+	vector<MemberListEntry> changed;
+	// failure timers of the members, at most one each
+	TimingWheel<int> expiry;
+	unordered_set<int> watched;
+	// phi accrual: recent heartbeat inter-arrival gaps of a member, in ticks
+	struct arrivalWindow {
+		int last;
+		vector<int> gaps;
+		int next;
+		double sum;
+		double sumsq;
+		arrivalWindow(): last(-1), next(0), sum(0), sumsq(0) {}
+	};
+	unordered_map<int, arrivalWindow> arrivals;
+	// phi accrual: standard deviations past the mean gap at which phi reaches the threshold
+	double phiSigma;
+	// members this node removed, with the tick
+	vector<pair<int, int> > removals;
+	// join state transfer: JOINREP chunks received so far, how many are missing and when we last asked
+	bool joining;
+	vector<bool> joinChunks;
+	int joinMissing;
+	int joinAsked;
+	void sendJoinReq(Address *joinaddr, int resume);
+	void recvJoinRep(char *data, int size);
+	vector< vector<MemberListEntry> > chunkMemberList(vector<MemberListEntry> &entries);
+	void markChanged(int id);
+	void watch(int id);
+	bool removedAt(MemberListEntry &entry);
+	long deadlineOf(int slot);
+	static double phiSigmas(double threshold);
+	vector<MemberListEntry> &gossipEntries(int since);
+
+	// SWIM: an update still to be piggybacked, and on how many messages it went out
+	struct swimUpdate {
+		int kind;
+		short port;
+		long incarnation;
+		int sent;
+	};
+	// SWIM: a ping sent on behalf of a PINGREQ, whose ACK goes back to the requester
+	struct swimRelay {
+		Address requester;
+		int seq;
+		int expires;
+	};
+	// SWIM: updates to piggyback, by member id
+	map<int, swimUpdate> updates;
+	// SWIM: suspected members and the tick the suspicion started
+	map<int, int> suspects;
+	// incarnation (SWIM) or heartbeat (gossip) at which members were removed, older news of them is stale
+	unordered_map<int, long> dead;
+	// SWIM: pings sent for others, by our sequence number
+	map<int, swimRelay> relays;
+	// SWIM: shuffled round of members to probe, and the probe under way
+	vector<int> probeOrder;
+	unsigned int probeNext;
+	int probeTarget;
+	int probeSeq;
+	int probeStart;
+	bool probeAcked;
+	bool probeIndirect;
+	int nextSeq;
+	void swimLoopOps();
+	void swimRecv(MsgTypes type, Address *sender, char *data, int size);
+	void swimSend(MsgTypes type, Address *to, int seq, Address *target);
+	void swimApply(int kind, int id, short port, long incarnation);
+	void swimQueue(int kind, int id, short port, long incarnation);
+	void swimSuspect(int slot);
+	void swimProbe();
+	Address addressOf(int id, short port);
 
 public:
 	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
 	Member * getMemberNode() {
 		return memberNode;
 	}
+	const vector<pair<int, int> > &getRemovals() {
+		return removals;
+	}
 	int recvLoop();
 	static int enqueueWrapper(void *env, char *buff, int size);
 	void nodeStart(char *servaddrstr, short serverport);
@@ -77,9 +191,14 @@ public:
 	void initMemberListTable(Member *memberNode);
 	void printAddress(Address *addr);
 	virtual ~MP1Node();
+	static int typeOf(char *data, int size);
+	static const char * const typeNames[DUMMYLASTMSGTYPE];
 
-	char* serializeMemberList();
+	void serializeMemberList(char *, vector<MemberListEntry> &);
+	string packMemberList(vector<MemberListEntry> &);
+	MessageHdr *newListMsg(MsgTypes, vector<MemberListEntry> &, int chunk, int chunks);
 	vector<MemberListEntry> deserializeMemberList(char *,int);
+	vector<MemberListEntry> unpackMemberList(char *,int);
 	void randomPickAndGossip();
 	int getid();
 };
@@ -15,6 +15,8 @@ MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log,
 	this->log = log;
 	ht = new HashTable();
 	this->memberNode->addr = *address;
+	this->ringEpoch = -1;
+	this->ring.setVnodes(par->VNODES);
 }
 
 /**
@@ -29,58 +31,92 @@ MP2Node::~MP2Node() {
  * FUNCTION NAME: updateRing
  *
  * DESCRIPTION: This function does the following:
- * 				1) Gets the current membership list from the Membership Protocol (MP1Node)
- * 				   The membership list is returned as a vector of Nodes. See Node class in Node.h
- * 				2) Constructs the ring based on the membership list
- * 				3) Calls the Stabilization Protocol
+ * 				1) Gets the membership changes from the Membership Protocol (MP1Node)
+ * 				   since the epoch the ring was last brought up to
+ * 				2) Applies them to the ring, or builds the ring again from the whole
+ * 				   membership list when MP1 no longer holds all of them
+ * 				3) Calls the Stabilization Protocol for the neighbors that changed
+ * 				Nothing is done while the membership epoch stays the same: the ring and the
+ * 				neighbors the stabilization protocol compares against would not change.
  */
 void MP2Node::updateRing() {
-	vector<Node> curMemList;
-	bool change = false;
+	vector<Node> pred, succ;
+	Ring was;
 
-	/*
-	 *  Step 1. Get the current membership list from Membership Protocol / MP1
-	 */
-	curMemList = getMembershipList();
+	if ( memberNode->epoch == ringEpoch ) {
+		return;
+	}
+	// with virtual nodes the keys are checked against the ring as it was
+	if ( par->VNODES > 1 && ht->currentSize() > 0 ) {
+		was = ring;
+	}
 
 	/*
-	 * Step 2: Construct the ring
+	 * Step 1 and 2: bring the ring up to the membership epoch
 	 */
-	// Sort the list based on the hashCode
-	sort(curMemList.begin(), curMemList.end());
-    
-    hasMyReplicas.clear();
-    haveReplicasOf.clear();
-    // check the ring in last round
-    if (ring.size() > 0) {
-        populateNeighborNodes();
-    }
-    
-    // assign the current ring
-    ring = curMemList;
+	if ( ringEpoch >= memberNode->changesFrom ) {
+		for ( unsigned int i = 0; i < memberNode->changes.size(); i++ ) {
+			member_change &change = memberNode->changes[i];
+			if ( change.epoch <= ringEpoch ) {
+				continue;
+			}
+			Address addr;
+			memcpy(&addr.addr[0], &change.id, sizeof(int));
+			memcpy(&addr.addr[4], &change.port, sizeof(short));
+			if ( change.added ) {
+				ring.insert(addr);
+			}
+			else {
+				ring.erase(addr);
+			}
+		}
+	}
+	else {
+		ring.assign(getMembershipList());
+	}
+	ringEpoch = memberNode->epoch;
 
 	/*
 	 * Step 3: Run the stabilization protocol IF REQUIRED
 	 */
-	// Run stabilization protocol if the hash table size is greater than zero and if there has been a changed in the ring
-    if (ring.size() > 0 && ht->currentSize() > 0) stabilizationProtocol();
+	if ( par->VNODES > 1 ) {
+		if ( ht->currentSize() > 0 ) {
+			stabilizeKeys(was);
+		}
+		return;
+	}
+	// Run it if the hash table size is greater than zero and our predecessors or successors changed
+	ring.neighbors(memberNode->addr, 2, pred, succ);
+	int events = neighborEvents(pred, succ);
+	if ( events && ht->currentSize() > 0 ) {
+		stabilizationProtocol(events);
+	}
+	haveReplicasOf = pred;
+	hasMyReplicas = succ;
 }
 
-// update hasMyReplicas and haveReplicasOf
-void MP2Node::populateNeighborNodes() {
-    int curHash = hashFunction(memberNode->addr.addr);
-    int i;
-    for (i = 0; i < ring.size(); i++) {
-        if (curHash == ring.at(i).getHashCode()) {
-            break;
-        }
-    }
-    
-    hasMyReplicas.push_back(ring.at((i + 1) % ring.size()));
-    hasMyReplicas.push_back(ring.at((i + 2) % ring.size()));
-    
-    haveReplicasOf.push_back( ring.at((i - 2 + ring.size()) % ring.size()) );
-    haveReplicasOf.push_back(ring.at((i - 1 + ring.size()) % ring.size()));   
+/**
+ * FUNCTION NAME: neighborEvents
+ *
+ * DESCRIPTION: Which of our two predecessors and two successors on the ring differ from
+ * 				the ones in haveReplicasOf and hasMyReplicas, as ringEvent bits.
+ * 				None before we had neighbors, or once we are off the ring.
+ */
+int MP2Node::neighborEvents(vector<Node> &pred, vector<Node> &succ) {
+	int events = 0;
+
+	if ( pred.empty() || haveReplicasOf.size() != pred.size() || hasMyReplicas.size() != succ.size() ) {
+		return 0;
+	}
+	for ( unsigned int i = 0; i < pred.size(); i++ ) {
+		if ( memcmp(pred[i].nodeAddress.addr, haveReplicasOf[i].nodeAddress.addr, sizeof(Address)) != 0 ) {
+			events |= RING_PREDECESSORS;
+		}
+		if ( memcmp(succ[i].nodeAddress.addr, hasMyReplicas[i].nodeAddress.addr, sizeof(Address)) != 0 ) {
+			events |= RING_SUCCESSORS;
+		}
+	}
+	return events;
 }
 
 /**
@@ -116,7 +152,7 @@ vector<Node> MP2Node::getMembershipList() {
  * RETURNS:
  * size_t position on the ring
  */
-size_t MP2Node::hashFunction(string key) {
+size_t MP2Node::hashFunction(const string &key) {
 	std::hash<string> hashFunc;
 	size_t ret = hashFunc(key);
 	return ret%RING_SIZE;
@@ -133,17 +169,13 @@ size_t MP2Node::hashFunction(string key) {
  */
 void MP2Node::clientCreate(string key, string value) {
     g_transID++;
-    vector<Node> replicas = findNodes(key);
+    const replica_set &replicas = findReplicas(key);
     Message msg(g_transID,memberNode->addr,CREATE,key,value,PRIMARY);
     quorum[g_transID] = vector<string>();
     outgoingMsgTimestamp[g_transID] = par->getcurrtime(); 
     outgoingMsg.emplace(g_transID,msg); // attention!!! opertor[] would result in compile-error 
        
-    Message msg_sec(g_transID,memberNode->addr,CREATE,key,value,SECONDARY);
-    Message msg_ter(g_transID,memberNode->addr,CREATE,key,value,TERTIARY);
-    sendMsg(msg,&replicas[0].nodeAddress);
-    sendMsg(msg_sec,&replicas[1].nodeAddress);
-    sendMsg(msg_ter,&replicas[2].nodeAddress);
+    sendToReplicas(msg,replicas);
 }
 
 /**
@@ -157,15 +189,13 @@ void MP2Node::clientCreate(string key, string value) {
  */
 void MP2Node::clientRead(string key){
     g_transID++;
-    vector<Node> replicas = findNodes(key);
+    const replica_set &replicas = findReplicas(key);
     Message msg(g_transID,memberNode->addr,READ,key);
     quorum[g_transID] = vector<string>();
     outgoingMsgTimestamp[g_transID] = par->getcurrtime(); 
    	outgoingMsg.emplace(g_transID,msg); // attention!!! opertor[] would result in compile-error 
        
-    sendMsg(msg,&replicas[0].nodeAddress);
-    sendMsg(msg,&replicas[1].nodeAddress);
-    sendMsg(msg,&replicas[2].nodeAddress);
+    sendToReplicas(msg,replicas);
 
 }
 
@@ -180,17 +210,13 @@ void MP2Node::clientRead(string key){
  */
 void MP2Node::clientUpdate(string key, string value){
     g_transID++;
-    vector<Node> replicas = findNodes(key);
+    const replica_set &replicas = findReplicas(key);
     Message msg(g_transID,memberNode->addr,UPDATE,key,value,PRIMARY);
     quorum[g_transID] = vector<string>();
     outgoingMsgTimestamp[g_transID] = par->getcurrtime(); 
    	outgoingMsg.emplace(g_transID,msg); // attention!!! opertor[] would result in compile-error 
        
-    Message msg_sec(g_transID,memberNode->addr,UPDATE,key,value,SECONDARY);
-    Message msg_ter(g_transID,memberNode->addr,UPDATE,key,value,TERTIARY);
-    sendMsg(msg,&replicas[0].nodeAddress);
-    sendMsg(msg_sec,&replicas[1].nodeAddress);
-    sendMsg(msg_ter,&replicas[2].nodeAddress);
+    sendToReplicas(msg,replicas);
 }
 
 /**
@@ -204,15 +230,13 @@ void MP2Node::clientUpdate(string key, string value){
  */
 void MP2Node::clientDelete(string key){
     g_transID++;
-    vector<Node> replicas = findNodes(key);
+    const replica_set &replicas = findReplicas(key);
     Message msg(g_transID,memberNode->addr,DELETE,key);
     quorum[g_transID] = vector<string>();
     outgoingMsgTimestamp[g_transID] = par->getcurrtime(); 
    	outgoingMsg.emplace(g_transID,msg); // attention!!! opertor[] would result in compile-error 
     
-    sendMsg(msg,&replicas[0].nodeAddress);
-    sendMsg(msg,&replicas[1].nodeAddress);
-    sendMsg(msg,&replicas[2].nodeAddress);
+    sendToReplicas(msg,replicas);
 }
 
 /**
@@ -280,6 +304,8 @@ void MP2Node::checkMessages() {
 	char * data;
 	int size;
 
+	flushBacklog();
+
 	// dequeue all messages and handle them
 	while ( !memberNode->mp2q.empty() ) {
 		/*
@@ -290,6 +316,7 @@ void MP2Node::checkMessages() {
 		memberNode->mp2q.pop();
 
 		string message(data, data + size - 1);
+		emulNet->ENfree(data);
 		/*
 		 * Handle the message types here
 		 */
@@ -301,23 +328,25 @@ void MP2Node::checkMessages() {
     
     // clean up
     // loop through all keys in quorum and check for time-outs    
-    for (auto it : outgoingMsgTimestamp) {
-        if (par->getcurrtime() - it.second > 10) {
+    for (auto it = outgoingMsgTimestamp.begin(); it != outgoingMsgTimestamp.end(); ) {
+        if (par->getcurrtime() - it->second > 10) {
 			// get type of msg
-            Message msg = outgoingMsg.at(it.first);
+            Message msg = outgoingMsg.at(it->first);
 			if (static_cast<MessageType>(msg.type) == CREATE) {
-				log->logCreateFail(&memberNode->addr,true,it.first,msg.key,msg.value);
+				log->logCreateFail(&memberNode->addr,true,it->first,msg.key,msg.value);
             }else if (static_cast<MessageType>(msg.type) == READ) {
-                log->logReadFail(&memberNode->addr,true,it.first,msg.key);
+                log->logReadFail(&memberNode->addr,true,it->first,msg.key);
             }else if (static_cast<MessageType>(msg.type) == UPDATE) {
-                log->logUpdateFail(&memberNode->addr,true,it.first,msg.key,msg.value);
+                log->logUpdateFail(&memberNode->addr,true,it->first,msg.key,msg.value);
             }else if (static_cast<MessageType>(msg.type) == DELETE) {
-                log->logDeleteFail(&memberNode->addr,true,it.first,msg.key);
+                log->logDeleteFail(&memberNode->addr,true,it->first,msg.key);
             }
             
-            quorum.erase(it.first);
-            outgoingMsg.erase(it.first);
-            outgoingMsgTimestamp.erase(it.first);
+            quorum.erase(it->first);
+            outgoingMsg.erase(it->first);
+            it = outgoingMsgTimestamp.erase(it);
+        }else {
+            ++it;
         }
     }
     
@@ -351,19 +380,72 @@ void MP2Node::handleMsg(string message) {
     }
 }
 
-// wrapper for message sending
+// wrapper for message sending, queues the message if the network pushes back
 void MP2Node::sendMsg(Message msg, Address *toAddr) {
     string msgStr = msg.toString();
-    char* msgChar = (char*)malloc(msgStr.size() + 1);
 
-    strcpy(msgChar,msgStr.c_str());
-    emulNet->ENsend(&memberNode->addr,toAddr,msgChar,msgStr.size() + 1);
-    
-    free(msgChar);
+    // keep the order: nothing overtakes what is already waiting
+    if (!sendBacklog.empty() || !trySend(msgStr,toAddr)) {
+        sendBacklog.push_back(make_pair(msgStr,*toAddr));
+    }
+}
+
+// send one message to every replica of a key, serialized once and shared by
+// the network; CREATE/UPDATE end with the replica type, patched per destination
+void MP2Node::sendToReplicas(Message msg, const replica_set &replicas) {
+    string msgStr = msg.toString();
+    int n = replicas.count;
+    bool typed = (msg.type == CREATE || msg.type == UPDATE);
+    int patchAt = msgStr.size() - 1;
+    Address to[REPLICAS];
+    char patches[REPLICAS];
+    int results[REPLICAS];
+
+    for (int i = 0; i < n; i++) {
+        to[i] = replicas.node[i].nodeAddress;
+        patches[i] = '0' + i;   // PRIMARY, SECONDARY, TERTIARY
+        results[i] = EN_BACKPRESSURE;
+    }
+
+    // keep the order: nothing overtakes what is already waiting
+    if (n > 0 && sendBacklog.empty()) {
+        char* msgChar = emulNet->ENalloc(msgStr.size() + 1);
+        memcpy(msgChar,msgStr.c_str(),msgStr.size() + 1);
+        emulNet->ENsendMulti(&memberNode->addr,&to[0],n,msgChar,patchAt,typed ? &patches[0] : NULL,&results[0]);
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (results[i] == EN_BACKPRESSURE) {
+            string copy = msgStr;
+            if (typed) {
+                copy[patchAt] = patches[i];
+            }
+            sendBacklog.push_back(make_pair(copy,to[i]));
+        }
+    }
+}
+
+// hand one message to the network, false if it was pushed back
+bool MP2Node::trySend(string &msgStr, Address *toAddr) {
+    char* msgChar = emulNet->ENalloc(msgStr.size() + 1);
+
+    memcpy(msgChar,msgStr.c_str(),msgStr.size() + 1);
+    return emulNet->ENsendBuffer(&memberNode->addr,toAddr,msgChar) != EN_BACKPRESSURE;
+}
+
+// resend pushed back messages until the network is full again
+void MP2Node::flushBacklog() {
+    while (!sendBacklog.empty() && trySend(sendBacklog.front().first,&sendBacklog.front().second)) {
+        sendBacklog.pop_front();
+    }
 }
 
 // handles READREPLY messages
 void MP2Node::readReplyMsgHandler(string originalMsg, string value, int transID) {
+    // late reply to a transaction that is already closed
+    if (outgoingMsg.find(transID) == outgoingMsg.end()) {
+        return;
+    }
     quorum[transID].push_back(originalMsg);
     
     if (quorum[transID].size() >= 2) {
@@ -394,6 +476,10 @@ void MP2Node::readMsgHandler(string key,int transID,string masterAddrStr) {
 
 // handles REPLY messages
 void MP2Node::replyMsgHandler(string originalMsg, string leftMsg,int transID) {
+    // late reply to a transaction that is already closed
+    if (outgoingMsg.find(transID) == outgoingMsg.end()) {
+        return;
+    }
     if (transID != 0) {
         quorum[transID].push_back(originalMsg);
     }
@@ -496,29 +582,20 @@ void MP2Node::createUpdateMsgHandler(string message, int transID, string masterA
  * 				This function is responsible for finding the replicas of a key
  */
 vector<Node> MP2Node::findNodes(string key) {
-	size_t pos = hashFunction(key);
-	vector<Node> addr_vec;
-	if (ring.size() >= 3) {
-		// if pos <= min || pos > max, the leader is the min
-		if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size()-1).getHashCode()) {
-			addr_vec.emplace_back(ring.at(0));
-			addr_vec.emplace_back(ring.at(1));
-			addr_vec.emplace_back(ring.at(2));
-		}
-		else {
-			// go through the ring until pos <= node
-			for (int i=1; i<ring.size(); i++){
-				Node addr = ring.at(i);
-				if (pos <= addr.getHashCode()) {
-					addr_vec.emplace_back(addr);
-					addr_vec.emplace_back(ring.at((i+1)%ring.size()));
-					addr_vec.emplace_back(ring.at((i+2)%ring.size()));
-					break;
-				}
-			}
-		}
-	}
-	return addr_vec;
+	const replica_set &replicas = findReplicas(key);
+	return vector<Node>(replicas.node, replicas.node + replicas.count);
+}
+
+/**
+ * FUNCTION NAME: findReplicas
+ *
+ * DESCRIPTION: Find the replicas of the given key without copying them: a binary search of
+ * 				the ring positions, then the cached replica set of that segment.
+ * 				The leader is the first node at or after the key's position, wrapping
+ * 				around to the first node. The reference is good until the ring next changes.
+ */
+const replica_set &MP2Node::findReplicas(const string &key) {
+	return ring.replicasOf(hashFunction(key));
 }
 
 /**
@@ -552,14 +629,12 @@ int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
  * 				The function does the following:
  *				1) Ensures that there are three "CORRECT" replicas of all the keys in spite of failures and joins
  *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
+ *				events says which side of this node changed, see neighborEvents; only that side is looked at
  */
-void MP2Node::stabilizationProtocol() {
-    int curHash = hashFunction(memberNode->addr.addr);
-    int i;
-    for (i = 0; i < ring.size(); i++) {
-        if (curHash == ring.at(i).getHashCode()) {
-            break;
-        }
+void MP2Node::stabilizationProtocol(int events) {
+    int i = ring.find(memberNode->addr);
+    if (i < 0 || haveReplicasOf.size() < 2 || hasMyReplicas.size() < 2) {
+        return;
     }
     
     Node pre1 = ring.at( ((i - 2 + ring.size()) % ring.size()) );
@@ -576,137 +651,199 @@ void MP2Node::stabilizationProtocol() {
      for (int i = 0; i < ring.size(); i++) {
          a += ring[i].nodeAddress.getAddress() + " ";
      }
-     const char * s = a.c_str();
-    // old pre1 fails
-    if (pre1.getHashCode() != haveReplicasOf[0].getHashCode() && pre2.getHashCode() == haveReplicasOf[1].getHashCode()) {
-        s = ("pre 1 " + a).c_str();
-        log->LOG(&memberNode->addr,s);
-    }
-    // old pre2 fails
-    // promote secondary to primary locally
-    else if (pre2.getHashCode() == haveReplicasOf[0].getHashCode() && pre2.getHashCode() != haveReplicasOf[1].getHashCode()) {
-        s = ("pre 2 " + a).c_str();
-        log->LOG(&memberNode->addr,s);
-        // promte current secondary to primary
-        // and send msg to post1 to promote tertiary to secondary
-        // send msg to post2 to create tertiary
-        for (auto it : ht->hashTable) {
-            string value;
-            int replicaType;
-            getValueAndReplicaType(it.second,value,replicaType);
+    // our predecessors changed: keys we held replicas of may now be ours
+    if (events & RING_PREDECESSORS) {
+        // old pre1 fails
+        if (pre1.getHashCode() != haveReplicasOf[0].getHashCode() && pre2.getHashCode() == haveReplicasOf[1].getHashCode()) {
+            log->LOG(&memberNode->addr,"pre 1 %s",a.c_str());
+        }
+        // old pre2 fails
+        // promote secondary to primary locally
+        else if (pre2.getHashCode() == haveReplicasOf[0].getHashCode() && pre2.getHashCode() != haveReplicasOf[1].getHashCode()) {
+            log->LOG(&memberNode->addr,"pre 2 %s",a.c_str());
+            // promte current secondary to primary
+            // and send msg to post1 to promote tertiary to secondary
+            // send msg to post2 to create tertiary
+            for (auto it : ht->hashTable) {
+                string value;
+                int replicaType;
+                getValueAndReplicaType(it.second,value,replicaType);
             
-            if (static_cast<ReplicaType>(replicaType) == SECONDARY) {
-                if (updateKeyValue(it.first,value,PRIMARY)) {
-                    log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
-                }else {
-                    log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
-                }
+                if (static_cast<ReplicaType>(replicaType) == SECONDARY) {
+                    if (updateKeyValue(it.first,value,PRIMARY)) {
+                        log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
+                    }else {
+                        log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
+                    }
                 
-                // send to next two availiable nodes 
-                Message msg_sec(0,memberNode->addr,UPDATE,it.first,value,SECONDARY);
-                Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
+                    // send to next two availiable nodes 
+                    Message msg_sec(0,memberNode->addr,UPDATE,it.first,value,SECONDARY);
+                    Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
                 
-                sendMsg(msg_sec,&(pre1.nodeAddress));
-                sendMsg(msg_ter,&(pre2.nodeAddress));
+                    sendMsg(msg_sec,&(pre1.nodeAddress));
+                    sendMsg(msg_ter,&(pre2.nodeAddress));
+                }
             }
         }
-    }
     
-    // both old pre1 and old pre2 fail
-    // promote both secondary and tertiary to primary locally
-    else if (pre1.getHashCode() != haveReplicasOf[0].getHashCode() && pre2.getHashCode() != haveReplicasOf[1].getHashCode()) {
-        s = ("pre 1 2 " + a).c_str();
-        log->LOG(&memberNode->addr,s);
-        for (auto it : ht->hashTable) {
-            string value;
-            int replicaType;
-            getValueAndReplicaType(it.second,value,replicaType);
+        // both old pre1 and old pre2 fail
+        // promote both secondary and tertiary to primary locally
+        else if (pre1.getHashCode() != haveReplicasOf[0].getHashCode() && pre2.getHashCode() != haveReplicasOf[1].getHashCode()) {
+            log->LOG(&memberNode->addr,"pre 1 2 %s",a.c_str());
+            for (auto it : ht->hashTable) {
+                string value;
+                int replicaType;
+                getValueAndReplicaType(it.second,value,replicaType);
             
-            if (static_cast<ReplicaType>(replicaType) == SECONDARY) {
-                if (updateKeyValue(it.first,value,PRIMARY)) {
-                    log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
-                }else {
-                    log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
-                }
-                //promoteTerToSec();
-                // create ter
-                // send to next two availiable nodes 
-                Message msg_sec(0,memberNode->addr,UPDATE,it.first,value,SECONDARY);
-                Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
+                if (static_cast<ReplicaType>(replicaType) == SECONDARY) {
+                    if (updateKeyValue(it.first,value,PRIMARY)) {
+                        log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
+                    }else {
+                        log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
+                    }
+                    //promoteTerToSec();
+                    // create ter
+                    // send to next two availiable nodes 
+                    Message msg_sec(0,memberNode->addr,UPDATE,it.first,value,SECONDARY);
+                    Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
                 
-                sendMsg(msg_sec,&(pre1.nodeAddress));
-                sendMsg(msg_ter,&(pre2.nodeAddress));
-            }
-            if (static_cast<ReplicaType>(replicaType) == TERTIARY) {
-                if (updateKeyValue(it.first,value,PRIMARY)) {
-                    log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
-                }else {
-                    log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
+                    sendMsg(msg_sec,&(pre1.nodeAddress));
+                    sendMsg(msg_ter,&(pre2.nodeAddress));
                 }
+                if (static_cast<ReplicaType>(replicaType) == TERTIARY) {
+                    if (updateKeyValue(it.first,value,PRIMARY)) {
+                        log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
+                    }else {
+                        log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
+                    }
                 
-                // send to next two availiable nodes 
-                Message msg_sec(0,memberNode->addr,CREATE,it.first,value,SECONDARY);
-                Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
+                    // send to next two availiable nodes 
+                    Message msg_sec(0,memberNode->addr,CREATE,it.first,value,SECONDARY);
+                    Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
                 
-                sendMsg(msg_sec,&(pre1.nodeAddress));
-                sendMsg(msg_ter,&(pre2.nodeAddress));
+                    sendMsg(msg_sec,&(pre1.nodeAddress));
+                    sendMsg(msg_ter,&(pre2.nodeAddress));
+                }
             }
         }
     }
-    
-    // only post2 fails
-    if (post1.getHashCode() == hasMyReplicas[0].getHashCode() && post2.getHashCode() != hasMyReplicas[1].getHashCode()) {
-        s = ("post 2 " + a).c_str();
-        log->LOG(&memberNode->addr, s);
-        for (auto it : ht->hashTable) {
-            string value;
-            int replicaType;
-            getValueAndReplicaType(it.second,value,replicaType);
+
+    // our successors changed: the replicas of our keys may have to move
+    if (events & RING_SUCCESSORS) {
+        // only post2 fails
+        if (post1.getHashCode() == hasMyReplicas[0].getHashCode() && post2.getHashCode() != hasMyReplicas[1].getHashCode()) {
+            log->LOG(&memberNode->addr,"post 2 %s",a.c_str());
+            for (auto it : ht->hashTable) {
+                string value;
+                int replicaType;
+                getValueAndReplicaType(it.second,value,replicaType);
             
-            if (static_cast<ReplicaType>(replicaType) == PRIMARY) {
-                Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
+                if (static_cast<ReplicaType>(replicaType) == PRIMARY) {
+                    Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
                 
-                sendMsg(msg_ter,&(post2.nodeAddress));
-            }    
+                    sendMsg(msg_ter,&(post2.nodeAddress));
+                }    
+            }
         }
-    }
-    // only post1 fails
-    else if (post1.getHashCode() != hasMyReplicas[0].getHashCode() && post1.getHashCode() == hasMyReplicas[1].getHashCode()) {
-        s = ("post 1 " + a).c_str();
-        log->LOG(&memberNode->addr,s);
-        for (auto it : ht->hashTable) {
-            string value;
-            int replicaType;
-            getValueAndReplicaType(it.second,value,replicaType);
+        // only post1 fails
+        else if (post1.getHashCode() != hasMyReplicas[0].getHashCode() && post1.getHashCode() == hasMyReplicas[1].getHashCode()) {
+            log->LOG(&memberNode->addr,"post 1 %s",a.c_str());
+            for (auto it : ht->hashTable) {
+                string value;
+                int replicaType;
+                getValueAndReplicaType(it.second,value,replicaType);
             
-            if (static_cast<ReplicaType>(replicaType) == PRIMARY) {
-                Message msg_sec(0,memberNode->addr,UPDATE,it.first,value,SECONDARY);
-                Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
+                if (static_cast<ReplicaType>(replicaType) == PRIMARY) {
+                    Message msg_sec(0,memberNode->addr,UPDATE,it.first,value,SECONDARY);
+                    Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
                 
-                sendMsg(msg_sec,&(post1.nodeAddress));
-                sendMsg(msg_ter,&(post2.nodeAddress));
-            }    
+                    sendMsg(msg_sec,&(post1.nodeAddress));
+                    sendMsg(msg_ter,&(post2.nodeAddress));
+                }    
+            }
         }
-    }
-    // both post1 and post2 fail
-    else if (post1.getHashCode() != hasMyReplicas[0].getHashCode() && post2.getHashCode() != hasMyReplicas[1].getHashCode()) {
-        s = ("post 1 2 " + a).c_str();
-        log->LOG(&memberNode->addr,s);
-        for (auto it : ht->hashTable) {
-            string value;
-            int replicaType;
-            getValueAndReplicaType(it.second,value,replicaType);
+        // both post1 and post2 fail
+        else if (post1.getHashCode() != hasMyReplicas[0].getHashCode() && post2.getHashCode() != hasMyReplicas[1].getHashCode()) {
+            log->LOG(&memberNode->addr,"post 1 2 %s",a.c_str());
+            for (auto it : ht->hashTable) {
+                string value;
+                int replicaType;
+                getValueAndReplicaType(it.second,value,replicaType);
             
-            if (static_cast<ReplicaType>(replicaType) == PRIMARY) {
-                Message msg_sec(0,memberNode->addr,CREATE,it.first,value,SECONDARY);
-                Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
+                if (static_cast<ReplicaType>(replicaType) == PRIMARY) {
+                    Message msg_sec(0,memberNode->addr,CREATE,it.first,value,SECONDARY);
+                    Message msg_ter(0,memberNode->addr,CREATE,it.first,value,TERTIARY);
                 
-                sendMsg(msg_sec,&(post1.nodeAddress));
-                sendMsg(msg_ter,&(post2.nodeAddress));
-            }    
+                    sendMsg(msg_sec,&(post1.nodeAddress));
+                    sendMsg(msg_ter,&(post2.nodeAddress));
+                }    
+            }
         }
     }
-    
+}
+
+/**
+ * FUNCTION NAME: stabilizeKeys
+ *
+ * DESCRIPTION: Stabilization with virtual nodes, where a member has many neighbors on the
+ * 				ring. Every key held here whose replica set changed from the ring was to
+ * 				the current one is looked at: our copy takes its place in the new set, and
+ * 				the first member of the old set still on the ring sends the key to the
+ * 				members new to the set. A key whose new set leaves us out is dropped
+ * 				here once it has been handed on.
+ */
+void MP2Node::stabilizeKeys(Ring &was) {
+    vector<string> gone;
+
+    for (auto it : ht->hashTable) {
+        size_t pos = hashFunction(it.first);
+        const replica_set &before = was.replicasOf(pos);
+        const replica_set &now = ring.replicasOf(pos);
+        int mine = -1, sender = -1;
+        string value;
+        int replicaType;
+
+        for (int k = 0; k < now.count; k++) {
+            if (memcmp(now.node[k].nodeAddress.addr, memberNode->addr.addr, sizeof(Address)) == 0) {
+                mine = k;
+            }
+        }
+        for (int k = 0; k < before.count && sender < 0; k++) {
+            Address addr = before.node[k].nodeAddress;
+            if (ring.find(addr) >= 0) {
+                sender = k;
+            }
+        }
+        getValueAndReplicaType(it.second,value,replicaType);
+
+        if (mine >= 0 && mine != replicaType) {
+            if (updateKeyValue(it.first,value,static_cast<ReplicaType>(mine))) {
+                log->logUpdateSuccess(&memberNode->addr,false,0,it.first,value);
+            }else {
+                log->logUpdateFail(&memberNode->addr,false,0,it.first,value);
+            }
+        }
+        if (mine < 0) {
+            gone.push_back(it.first);
+        }
+        if (sender < 0 || memcmp(before.node[sender].nodeAddress.addr, memberNode->addr.addr, sizeof(Address)) != 0) {
+            continue;
+        }
+        for (int k = 0; k < now.count; k++) {
+            bool held = false;
+            for (int j = 0; j < before.count && !held; j++) {
+                held = memcmp(before.node[j].nodeAddress.addr, now.node[k].nodeAddress.addr, sizeof(Address)) == 0;
+            }
+            if (!held) {
+                Message msg(0,memberNode->addr,CREATE,it.first,value,static_cast<ReplicaType>(k));
+                Address to = now.node[k].nodeAddress;
+                sendMsg(msg,&to);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < gone.size(); i++) {
+        deletekey(gone[i]);
+    }
 }
 
 void MP2Node::getValueAndReplicaType(string str, string &value, int &replicaType) {
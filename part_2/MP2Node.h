@@ -13,6 +13,7 @@
 #include "stdincludes.h"
 #include "EmulNet.h"
 #include "Node.h"
+#include "Ring.h"
 #include "HashTable.h"
 #include "Log.h"
 #include "Params.h"
@@ -37,7 +38,9 @@ private:
 	// Vector holding the previous two neighbors in the ring whose replicas I have
 	vector<Node> haveReplicasOf;
 	// Ring
-	vector<Node> ring;
+	Ring ring;
+	// membership epoch the ring was built from
+	long ringEpoch;
 	// Hash Table
 	HashTable * ht;
 	// Member representing this member
@@ -55,6 +58,8 @@ private:
     unordered_map<int,Message> outgoingMsg;
     // <transID,timestamp>
     unordered_map<int,int> outgoingMsgTimestamp;
+    // messages the network pushed back, resent in order on later ticks
+    deque<pair<string,Address> > sendBacklog;
 
 public:
 	MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *addressOfMember);
@@ -65,7 +70,7 @@ public:
 	// ring functionalities
 	void updateRing();
 	vector<Node> getMembershipList();
-	size_t hashFunction(string key);
+	size_t hashFunction(const string &key);
 	void findNeighbors();
 
 	// client side CRUD APIs
@@ -86,6 +91,7 @@ public:
 
 	// find the addresses of nodes that are responsible for a key
 	vector<Node> findNodes(string key);
+	const replica_set &findReplicas(const string &key);
 
 	// server
 	bool createKeyValue(string key, string value, ReplicaType replica);
@@ -94,11 +100,20 @@ public:
 	bool deletekey(string key);
 
 	// stabilization protocol - handle multiple failures
-	void stabilizationProtocol();
+	void stabilizationProtocol(int events);
+	void stabilizeKeys(Ring &was);
+
+	// ring positions each member is the primary of
+	void ownership(map<string, int> &share) {
+		ring.ownership(share);
+	}
     
-    void populateNeighborNodes();
+    int neighborEvents(vector<Node> &pred, vector<Node> &succ);
     void handleMsg(string);
     void sendMsg(Message, Address*);
+    void sendToReplicas(Message, const replica_set &);
+    bool trySend(string &, Address *);
+    void flushBacklog();
     void createUpdateMsgHandler(string, int, string, MessageType);
     void deleteMsgHandler(string, int, string);
     void replyMsgHandler(string,string,int);
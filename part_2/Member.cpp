@@ -152,6 +152,10 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberIndex = anotherMember.memberIndex;
+	this->epoch = anotherMember.epoch;
+	this->changes = anotherMember.changes;
+	this->changesFrom = anotherMember.changesFrom;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
@@ -170,8 +174,91 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberIndex = anotherMember.memberIndex;
+	this->epoch = anotherMember.epoch;
+	this->changes = anotherMember.changes;
+	this->changesFrom = anotherMember.changesFrom;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
 	return *this;
 }
+
+/**
+ * FUNCTION NAME: findMember
+ *
+ * DESCRIPTION: Slot of member id in memberList, -1 if it is not there
+ */
+int Member::findMember(int id) {
+	return memberIndex.find(id);
+}
+
+/**
+ * FUNCTION NAME: addMember
+ *
+ * DESCRIPTION: Append an entry for a member that is not in memberList yet
+ */
+void Member::addMember(const MemberListEntry &entry) {
+	memberIndex.set(entry.id, memberList.size());
+	memberList.push_back(entry);
+	noteChange(entry.id, entry.port, true);
+}
+
+/**
+ * FUNCTION NAME: removeMemberAt
+ *
+ * DESCRIPTION: Remove the entry at slot by moving the last entry into its place.
+ * 				The entry now at slot, if any, has not been looked at by a loop over
+ * 				the slots yet.
+ */
+void Member::removeMemberAt(int slot) {
+	int last = memberList.size() - 1;
+	noteChange(memberList[slot].id, memberList[slot].port, false);
+	memberIndex.erase(memberList[slot].id);
+	if ( slot != last ) {
+		memberList[slot] = memberList[last];
+		memberIndex.set(memberList[slot].id, slot);
+	}
+	memberList.pop_back();
+}
+
+/**
+ * FUNCTION NAME: setMembers
+ *
+ * DESCRIPTION: Replace memberList with entries, keeping the first entry of each id
+ */
+void Member::setMembers(const vector<MemberListEntry> &entries) {
+	clearMembers();
+	for ( unsigned int i = 0; i < entries.size(); i++ ) {
+		if ( findMember(entries[i].id) < 0 ) {
+			addMember(entries[i]);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: clearMembers
+ *
+ * DESCRIPTION: Empty memberList
+ */
+void Member::clearMembers() {
+	memberList.clear();
+	memberIndex.clear();
+	epoch++;
+	changes.clear();
+	changesFrom = epoch;
+}
+
+/**
+ * FUNCTION NAME: noteChange
+ *
+ * DESCRIPTION: Move to the next epoch, recording the add or remove of member id that made it
+ */
+void Member::noteChange(int id, short port, bool added) {
+	member_change change = { ++epoch, id, port, added };
+	changes.push_back(change);
+	if ( changes.size() > MEMBER_CHANGES ) {
+		changesFrom = changes.front().epoch;
+		changes.pop_front();
+	}
+}
@@ -8,6 +8,7 @@
 #define MEMBER_H_
 
 #include "stdincludes.h"
+#include "MemberIndex.h"
 
 /**
  * CLASS NAME: q_elt
@@ -80,6 +81,21 @@ public:
 	void settimestamp(long timestamp);
 };
 
+/**
+ * Struct Name: member_change
+ *
+ * DESCRIPTION: A member added to or taken out of the membership table, and the epoch that made
+ */
+typedef struct member_change {
+	long epoch;
+	int id;
+	short port;
+	bool added;
+}member_change;
+
+// changes a Member keeps for readers catching up with its epoch
+#define MEMBER_CHANGES 256
+
 /**
  * CLASS NAME: Member
  *
@@ -104,8 +120,16 @@ public:
 	int pingCounter;
 	// counter for ping timeout
 	int timeOutCounter;
-	// Membership table
+	// Membership table. Change it through the functions below, which keep memberIndex in step
 	vector<MemberListEntry> memberList;
+	// slot of each member id in memberList
+	MemberIndex memberIndex;
+	// membership epoch: goes up whenever a member is added or removed, never otherwise
+	long epoch;
+	// the last MEMBER_CHANGES adds and removes, oldest first. A reader that has seen
+	// epoch e can catch up from them if e >= changesFrom; otherwise it starts over
+	deque<member_change> changes;
+	long changesFrom;
 	// My position in the membership table
 	vector<MemberListEntry>::iterator myPos;
 	// Queue for failure detection messages
@@ -115,11 +139,17 @@ public:
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), epoch(0), changesFrom(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
 	Member& operator =(const Member &anotherMember);
+	int findMember(int id);
+	void addMember(const MemberListEntry &entry);
+	void removeMemberAt(int slot);
+	void setMembers(const vector<MemberListEntry> &entries);
+	void clearMembers();
+	void noteChange(int id, short port, bool added);
 	virtual ~Member() {}
 };
 
@@ -0,0 +1,118 @@
+/**********************************
+ * FILE NAME: MemberIndex.h
+ *
+ * DESCRIPTION: Open addressing map from member id to membership table slot
+ **********************************/
+
+#ifndef MEMBERINDEX_H_
+#define MEMBERINDEX_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/**
+ * CLASS NAME: MemberIndex
+ *
+ * DESCRIPTION: Maps a member id to its slot in the membership table.
+ * 				Linear probing over a power of two table kept at most half full;
+ * 				erase shifts the rest of the probe run back instead of leaving
+ * 				tombstones, so lookups stay short however much the membership churns.
+ */
+class MemberIndex {
+private:
+	struct bucket {
+		int id;
+		int slot;
+	};
+	vector<bucket> table;
+	int count;
+
+	static const int EMPTY = INT32_MIN;
+
+	unsigned int home(int id) {
+		return ((uint32_t)id * 2654435761u) & (table.size() - 1);
+	}
+
+	unsigned int probe(int id) {
+		unsigned int i = home(id);
+		while ( table[i].id != EMPTY && table[i].id != id ) {
+			i = (i + 1) & (table.size() - 1);
+		}
+		return i;
+	}
+
+	void grow() {
+		vector<bucket> old;
+		old.swap(table);
+		bucket empty = { EMPTY, -1 };
+		table.assign(old.empty() ? 16 : old.size() * 2, empty);
+		for ( unsigned int i = 0; i < old.size(); i++ ) {
+			if ( old[i].id != EMPTY ) {
+				table[probe(old[i].id)] = old[i];
+			}
+		}
+	}
+
+public:
+	MemberIndex(): count(0) {}
+
+	// slot of member id, -1 if it has none
+	int find(int id) {
+		if ( table.empty() ) {
+			return -1;
+		}
+		bucket &b = table[probe(id)];
+		return ( b.id == id ) ? b.slot : -1;
+	}
+
+	// add member id or move it to another slot
+	void set(int id, int slot) {
+		if ( 2 * (count + 1) > (int)table.size() ) {
+			grow();
+		}
+		bucket &b = table[probe(id)];
+		if ( b.id != id ) {
+			b.id = id;
+			count++;
+		}
+		b.slot = slot;
+	}
+
+	void erase(int id) {
+		if ( table.empty() ) {
+			return;
+		}
+		unsigned int mask = table.size() - 1;
+		unsigned int i = probe(id);
+		if ( table[i].id != id ) {
+			return;
+		}
+		// pull back later entries of the run that would no longer be reachable
+		unsigned int j = i;
+		for ( ;; ) {
+			j = (j + 1) & mask;
+			if ( table[j].id == EMPTY ) {
+				break;
+			}
+			unsigned int k = home(table[j].id);
+			if ( ((j - k) & mask) >= ((j - i) & mask) ) {
+				table[i] = table[j];
+				i = j;
+			}
+		}
+		table[i].id = EMPTY;
+		table[i].slot = -1;
+		count--;
+	}
+
+	void clear() {
+		table.clear();
+		count = 0;
+	}
+
+	int size() {
+		return count;
+	}
+};
+
+#endif /* MEMBERINDEX_H_ */
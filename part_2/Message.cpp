@@ -174,3 +174,25 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->value = anotherMessage.value;
 	return *this;
 }
+
+// names of the MessageTypes, for the network's per type accounting
+const char * const Message::typeNames[READREPLY + 1] = { "CREATE", "READ", "UPDATE", "DELETE", "REPLY", "READREPLY" };
+
+/**
+ * FUNCTION NAME: typeOf
+ *
+ * DESCRIPTION: Type field of a serialized message, the one after the second delimiter.
+ * 				-1 if the payload does not look like a message.
+ */
+int Message::typeOf(char *data, int size) {
+	int fields = 0;
+	for ( int i = 0; i + 1 < size && data[i]; i++ ) {
+		if ( data[i] == ':' && data[i + 1] == ':' ) {
+			if ( ++fields == 2 ) {
+				return ( i + 2 < size && isdigit(data[i + 2]) ) ? atoi(data + i + 2) : -1;
+			}
+			i++;
+		}
+	}
+	return -1;
+}
@@ -41,6 +41,9 @@ public:
 	Message& operator = (const Message& anotherMessage);
 	// serialize to a string
 	string toString();
+	// type of a serialized message, without parsing the rest of it
+	static int typeOf(char *data, int size);
+	static const char * const typeNames[READREPLY + 1];
 };
 
 #endif
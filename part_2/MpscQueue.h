@@ -0,0 +1,80 @@
+/**********************************
+ * FILE NAME: MpscQueue.h
+ *
+ * DESCRIPTION: Lock-free multi-producer single-consumer queue
+ **********************************/
+
+#ifndef MPSCQUEUE_H_
+#define MPSCQUEUE_H_
+
+#include "stdincludes.h"
+
+/**
+ * CLASS NAME: MpscQueue
+ *
+ * DESCRIPTION: Intrusive FIFO (Vyukov) for nodes of type T, which must have a
+ * 				member "atomic<T*> next". Any number of threads may push concurrently;
+ * 				only one thread at a time may pop. A push that is still in progress
+ * 				may be missed by a concurrent pop and is returned by a later one.
+ */
+template <class T>
+class MpscQueue {
+private:
+	atomic<T*> head;
+	T *tail;
+	T stub;
+	MpscQueue(const MpscQueue &);
+	MpscQueue& operator =(const MpscQueue &);
+public:
+	MpscQueue(): head(&stub), tail(&stub) {
+		stub.next.store(NULL, memory_order_relaxed);
+	}
+
+	/**
+	 * FUNCTION NAME: push
+	 *
+	 * DESCRIPTION: Append n; safe from any thread
+	 */
+	void push(T *n) {
+		n->next.store(NULL, memory_order_relaxed);
+		T *prev = head.exchange(n, memory_order_acq_rel);
+		prev->next.store(n, memory_order_release);
+	}
+
+	/**
+	 * FUNCTION NAME: pop
+	 *
+	 * DESCRIPTION: Remove the oldest node; consumer thread only
+	 *
+	 * RETURNS:
+	 * the node, or NULL if the queue is (momentarily) empty
+	 */
+	T *pop() {
+		T *t = tail;
+		T *next = t->next.load(memory_order_acquire);
+		if ( t == &stub ) {
+			if ( next == NULL ) {
+				return NULL;
+			}
+			tail = next;
+			t = next;
+			next = next->next.load(memory_order_acquire);
+		}
+		if ( next ) {
+			tail = next;
+			return t;
+		}
+		if ( t != head.load(memory_order_acquire) ) {
+			return NULL;
+		}
+		push(&stub);
+		next = t->next.load(memory_order_acquire);
+		if ( next ) {
+			tail = next;
+			return t;
+		}
+		return NULL;
+	}
+};
+
+#endif /* MPSCQUEUE_H_ */
@@ -0,0 +1,169 @@
+/**********************************
+ * FILE NAME: MsgPool.cpp
+ *
+ * DESCRIPTION: Definition of the message frame pool
+ **********************************/
+
+#include "MsgPool.h"
+
+/**
+ * Constructor
+ */
+MsgPool::MsgPool() {
+	oversize = 0;
+	threadSafe = false;
+	for ( int i = 0; i < POOL_CLASSES; i++ ) {
+		freeList[i] = NULL;
+		bump[i] = bumpEnd[i] = NULL;
+		memset(&stats[i], 0, sizeof(classStats));
+	}
+}
+
+/**
+ * Destructor
+ */
+MsgPool::~MsgPool() {
+	for ( unsigned int i = 0; i < slabs.size(); i++ ) {
+		free(slabs[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: setThreadSafe
+ *
+ * DESCRIPTION: Serialize alloc/release so frames can move between threads
+ */
+void MsgPool::setThreadSafe(bool on) {
+	threadSafe = on;
+}
+
+/**
+ * FUNCTION NAME: sizeClass
+ *
+ * DESCRIPTION: Map a request size to its size class
+ *
+ * RETURNS:
+ * class index, or -1 if the request is served by malloc
+ */
+int MsgPool::sizeClass(size_t size) {
+	int cls = 0;
+	size_t blockSize = (size_t)1 << POOL_MIN_SHIFT;
+	while ( blockSize < size ) {
+		blockSize <<= 1;
+		if ( ++cls == POOL_CLASSES ) {
+			return -1;
+		}
+	}
+	return cls;
+}
+
+/**
+ * FUNCTION NAME: refill
+ *
+ * DESCRIPTION: Start carving a fresh slab for the given class
+ */
+void MsgPool::refill(int cls) {
+	char *slab = (char *)malloc(POOL_SLAB_SIZE);
+	slabs.push_back(slab);
+	stats[cls].slabs++;
+	bump[cls] = slab;
+	bumpEnd[cls] = slab + POOL_SLAB_SIZE;
+}
+
+/**
+ * FUNCTION NAME: alloc
+ *
+ * DESCRIPTION: Get a block of at least size bytes
+ */
+void *MsgPool::alloc(size_t size) {
+	if ( threadSafe ) {
+		lock_guard<mutex> guard(lock);
+		return allocLocked(size);
+	}
+	return allocLocked(size);
+}
+
+/**
+ * FUNCTION NAME: release
+ *
+ * DESCRIPTION: Return a block obtained from alloc with the same size
+ */
+void MsgPool::release(void *block, size_t size) {
+	if ( threadSafe ) {
+		lock_guard<mutex> guard(lock);
+		releaseLocked(block, size);
+		return;
+	}
+	releaseLocked(block, size);
+}
+
+/**
+ * FUNCTION NAME: allocLocked
+ *
+ * DESCRIPTION: alloc, with the lock (if any) held
+ */
+void *MsgPool::allocLocked(size_t size) {
+	int cls = sizeClass(size);
+	if ( cls < 0 ) {
+		oversize++;
+		return malloc(size);
+	}
+
+	classStats &st = stats[cls];
+	size_t blockSize = (size_t)1 << (POOL_MIN_SHIFT + cls);
+	void *block;
+
+	st.allocs++;
+	if ( ++st.inUse > st.highWater ) {
+		st.highWater = st.inUse;
+	}
+
+	if ( freeList[cls] ) {
+		st.recycled++;
+		block = freeList[cls];
+		freeList[cls] = freeList[cls]->next;
+		return block;
+	}
+
+	if ( bump[cls] == NULL || bump[cls] + blockSize > bumpEnd[cls] ) {
+		refill(cls);
+	}
+	block = bump[cls];
+	bump[cls] += blockSize;
+	return block;
+}
+
+/**
+ * FUNCTION NAME: releaseLocked
+ *
+ * DESCRIPTION: release, with the lock (if any) held
+ */
+void MsgPool::releaseLocked(void *block, size_t size) {
+	int cls = sizeClass(size);
+	if ( cls < 0 ) {
+		free(block);
+		return;
+	}
+
+	stats[cls].frees++;
+	stats[cls].inUse--;
+	((freeBlock *)block)->next = freeList[cls];
+	freeList[cls] = (freeBlock *)block;
+}
+
+/**
+ * FUNCTION NAME: printStats
+ *
+ * DESCRIPTION: Dump per class allocation and recycling counters
+ */
+void MsgPool::printStats(FILE *file, const char *name) {
+	fprintf(file, "%s pool: %lu slabs of %d B, %ld oversize allocs\n", name, slabs.size(), POOL_SLAB_SIZE, oversize);
+	for ( int i = 0; i < POOL_CLASSES; i++ ) {
+		if ( stats[i].allocs == 0 ) {
+			continue;
+		}
+		fprintf(file, "  class %5d B allocs %8ld recycled %8ld frees %8ld slabs %4ld in_use %6ld high_water %6ld\n",
+				1 << (POOL_MIN_SHIFT + i), stats[i].allocs, stats[i].recycled, stats[i].frees,
+				stats[i].slabs, stats[i].inUse, stats[i].highWater);
+	}
+}
@@ -0,0 +1,68 @@
+/**********************************
+ * FILE NAME: MsgPool.h
+ *
+ * DESCRIPTION: Header file of the message frame pool
+ **********************************/
+
+#ifndef MSGPOOL_H_
+#define MSGPOOL_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// smallest size class is 1 << POOL_MIN_SHIFT bytes
+#define POOL_MIN_SHIFT 5
+// number of power of two size classes, the largest being 4 KB
+#define POOL_CLASSES 8
+#define POOL_SLAB_SIZE (64 * 1024)
+
+/**
+ * CLASS NAME: MsgPool
+ *
+ * DESCRIPTION: Size-classed slab allocator for message frames.
+ * 				Each class carves fixed size blocks out of 64 KB slabs on demand and
+ * 				recycles freed blocks through an intrusive free list. Requests larger than the
+ * 				biggest class fall back to malloc.
+ * 				The pool is single threaded unless setThreadSafe(true) is called.
+ */
+class MsgPool {
+private:
+	struct freeBlock {
+		freeBlock *next;
+	};
+	struct classStats {
+		long allocs;
+		long recycled;
+		long frees;
+		long slabs;
+		long inUse;
+		long highWater;
+	};
+	freeBlock *freeList[POOL_CLASSES];
+	// uncarved remainder of the newest slab of each class
+	char *bump[POOL_CLASSES];
+	char *bumpEnd[POOL_CLASSES];
+	classStats stats[POOL_CLASSES];
+	vector<char *> slabs;
+	long oversize;
+	// taken around every operation once setThreadSafe(true) was called
+	mutex lock;
+	bool threadSafe;
+	void *allocLocked(size_t size);
+	void releaseLocked(void *block, size_t size);
+	int sizeClass(size_t size);
+	void refill(int cls);
+	MsgPool(const MsgPool &);
+	MsgPool& operator =(const MsgPool &);
+public:
+	MsgPool();
+	void setThreadSafe(bool on);
+	void *alloc(size_t size);
+	void release(void *block, size_t size);
+	void printStats(FILE *file, const char *name);
+	virtual ~MsgPool();
+};
+
+#endif /* MSGPOOL_H_ */
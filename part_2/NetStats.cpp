@@ -0,0 +1,306 @@
+/**********************************
+ * FILE NAME: NetStats.cpp
+ *
+ * DESCRIPTION: Definition of the network statistics store
+ **********************************/
+
+#include "NetStats.h"
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Make room for the counters of node id
+ */
+void NetStats::addNode(int id) {
+	assert(id >= 0);
+	if ( id >= (int)nodes.size() ) {
+		nodes.resize(id + 1);
+		types.resize(id + 1);
+	}
+}
+
+/**
+ * FUNCTION NAME: at
+ *
+ * DESCRIPTION: Counters of node id at the given tick, growing the row as needed
+ */
+NetStats::tickCount &NetStats::at(int id, int time) {
+	assert(time >= 0);
+	addNode(id);
+	vector<tickCount> &row = nodes[id];
+	if ( time >= (int)row.size() ) {
+		tickCount zero;
+		memset(&zero, 0, sizeof(zero));
+		row.resize(time + 1, zero);
+	}
+	return row[time];
+}
+
+/**
+ * FUNCTION NAME: typeAt
+ *
+ * DESCRIPTION: Per type counters of node id, growing the row as needed
+ */
+type_count &NetStats::typeAt(int id, int type) {
+	assert(type >= 0);
+	addNode(id);
+	vector<type_count> &row = types[id];
+	if ( type >= (int)row.size() ) {
+		type_count zero;
+		memset(&zero, 0, sizeof(zero));
+		row.resize(type + 1, zero);
+	}
+	return row[type];
+}
+
+/**
+ * FUNCTION NAME: get
+ *
+ * DESCRIPTION: One counter of node id at the given tick, 0 if never touched
+ */
+int NetStats::get(int id, int time, statColumn col) {
+	if ( id < 0 || id >= (int)nodes.size() || time < 0 || time >= (int)nodes[id].size() ) {
+		return 0;
+	}
+	return nodes[id][time].v[col];
+}
+
+/**
+ * FUNCTION NAME: countSent
+ *
+ * DESCRIPTION: Record one message of the given payload size sent by node id
+ */
+void NetStats::countSent(int id, int time, int bytes) {
+	tickCount &c = at(id, time);
+	c.v[COL_SENT]++;
+	c.v[COL_SENT_BYTES] += bytes;
+}
+
+/**
+ * FUNCTION NAME: countRecv
+ *
+ * DESCRIPTION: Record one message of the given payload size received by node id
+ */
+void NetStats::countRecv(int id, int time, int bytes) {
+	tickCount &c = at(id, time);
+	c.v[COL_RECV]++;
+	c.v[COL_RECV_BYTES] += bytes;
+}
+
+/**
+ * FUNCTION NAME: countDrop
+ *
+ * DESCRIPTION: Record one message of node id that the network lost
+ */
+void NetStats::countDrop(int id, int time, dropCause cause) {
+	at(id, time).v[COL_DROP_TOO_BIG + cause]++;
+}
+
+/**
+ * FUNCTION NAME: setDepth
+ *
+ * DESCRIPTION: Record how many messages were still held for node id after it received
+ */
+void NetStats::setDepth(int id, int time, int depth) {
+	// rows only grow for ticks with something to record
+	if ( depth > 0 ) {
+		at(id, time).v[COL_DEPTH] = depth;
+	}
+}
+
+/**
+ * FUNCTION NAME: countTypeSent
+ *
+ * DESCRIPTION: Record one message of the given type and payload size sent by node id
+ */
+void NetStats::countTypeSent(int id, int type, int bytes) {
+	type_count &c = typeAt(id, type);
+	c.sent++;
+	c.sentBytes += bytes;
+}
+
+/**
+ * FUNCTION NAME: countTypeRecv
+ *
+ * DESCRIPTION: Record one message of the given type and payload size received by node id
+ */
+void NetStats::countTypeRecv(int id, int type, int bytes) {
+	type_count &c = typeAt(id, type);
+	c.recv++;
+	c.recvBytes += bytes;
+}
+
+/**
+ * FUNCTION NAME: getSent
+ *
+ * DESCRIPTION: Messages sent by node id at the given tick
+ */
+int NetStats::getSent(int id, int time) {
+	return get(id, time, COL_SENT);
+}
+
+/**
+ * FUNCTION NAME: getRecv
+ *
+ * DESCRIPTION: Messages received by node id at the given tick
+ */
+int NetStats::getRecv(int id, int time) {
+	return get(id, time, COL_RECV);
+}
+
+/**
+ * FUNCTION NAME: getDrops
+ *
+ * DESCRIPTION: Messages of node id lost for the given cause over the whole run
+ */
+int NetStats::getDrops(int id, dropCause cause) {
+	int total = 0;
+	if ( id < 0 || id >= (int)nodes.size() ) {
+		return 0;
+	}
+	for ( unsigned int t = 0; t < nodes[id].size(); t++ ) {
+		total += nodes[id][t].v[COL_DROP_TOO_BIG + cause];
+	}
+	return total;
+}
+
+/**
+ * FUNCTION NAME: countPushback
+ *
+ * DESCRIPTION: Record one message of node id that the network had no room for
+ */
+void NetStats::countPushback(int id, int time) {
+	at(id, time).v[COL_PUSHBACK]++;
+}
+
+/**
+ * FUNCTION NAME: getPushbacks
+ *
+ * DESCRIPTION: Messages of node id the network had no room for over the whole run
+ */
+int NetStats::getPushbacks(int id) {
+	int total = 0;
+	if ( id < 0 || id >= (int)nodes.size() ) {
+		return 0;
+	}
+	for ( unsigned int t = 0; t < nodes[id].size(); t++ ) {
+		total += nodes[id][t].v[COL_PUSHBACK];
+	}
+	return total;
+}
+
+/**
+ * FUNCTION NAME: getTypeTotal
+ *
+ * DESCRIPTION: Traffic of the given message type summed over all nodes and the whole run
+ */
+type_count NetStats::getTypeTotal(int type) {
+	type_count total;
+	memset(&total, 0, sizeof(total));
+	for ( unsigned int i = 0; i < types.size(); i++ ) {
+		if ( type < (int)types[i].size() ) {
+			total.sent += types[i][type].sent;
+			total.sentBytes += types[i][type].sentBytes;
+			total.recv += types[i][type].recv;
+			total.recvBytes += types[i][type].recvBytes;
+		}
+	}
+	return total;
+}
+
+/**
+ * FUNCTION NAME: exportBinary
+ *
+ * DESCRIPTION: Write the counters of node ids firstId .. lastId for ticks 0 .. ticks - 1
+ * 				to path in the columnar layout described by stats_header
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int NetStats::exportBinary(const char *path, int firstId, int lastId, int ticks) {
+	stats_header hdr;
+	char name[STATS_NAME_LEN];
+	int count = max(0, lastId - firstId + 1);
+	vector<int32_t> column(count * ticks);
+
+	FILE *fp = fopen(path, "wb");
+	if ( fp == NULL ) {
+		return FAILURE;
+	}
+
+	memcpy(hdr.magic, STATS_MAGIC, sizeof(hdr.magic));
+	hdr.columns = STAT_COLUMNS;
+	hdr.firstId = firstId;
+	hdr.nodes = count;
+	hdr.ticks = ticks;
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	for ( int c = 0; c < STAT_COLUMNS; c++ ) {
+		memset(name, 0, sizeof(name));
+		strncpy(name, columnName((statColumn)c), sizeof(name) - 1);
+		fwrite(name, sizeof(name), 1, fp);
+	}
+
+	for ( int c = 0; c < STAT_COLUMNS; c++ ) {
+		for ( int k = 0; k < count; k++ ) {
+			for ( int t = 0; t < ticks; t++ ) {
+				column[k * ticks + t] = get(firstId + k, t, (statColumn)c);
+			}
+		}
+		fwrite(column.data(), sizeof(int32_t), column.size(), fp);
+	}
+
+	fclose(fp);
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: causeName
+ *
+ * DESCRIPTION: Short label of a drop cause, for the logs
+ */
+const char *NetStats::causeName(dropCause cause) {
+	switch ( cause ) {
+		case DROP_TOO_BIG:
+			return "too_big";
+		case DROP_LOSS:
+			return "loss";
+		case DROP_UNREACHABLE:
+			return "unreachable";
+		case DROP_REFUSED:
+			return "refused";
+		default:
+			return "?";
+	}
+}
+
+/**
+ * FUNCTION NAME: columnName
+ *
+ * DESCRIPTION: Name of a column of the binary export
+ */
+const char *NetStats::columnName(statColumn col) {
+	switch ( col ) {
+		case COL_SENT:
+			return "sent";
+		case COL_RECV:
+			return "recv";
+		case COL_SENT_BYTES:
+			return "sent_bytes";
+		case COL_RECV_BYTES:
+			return "recv_bytes";
+		case COL_PUSHBACK:
+			return "pushback";
+		case COL_DROP_TOO_BIG:
+			return "drop_too_big";
+		case COL_DROP_LOSS:
+			return "drop_loss";
+		case COL_DROP_UNREACHABLE:
+			return "drop_unreachable";
+		case COL_DROP_REFUSED:
+			return "drop_refused";
+		case COL_DEPTH:
+			return "depth";
+		default:
+			return "?";
+	}
+}
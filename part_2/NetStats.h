@@ -0,0 +1,94 @@
+/**********************************
+ * FILE NAME: NetStats.h
+ *
+ * DESCRIPTION: Header file of the network statistics store
+ **********************************/
+
+#ifndef NETSTATS_H_
+#define NETSTATS_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/*
+ * Reasons for the network to lose a message
+ */
+enum dropCause { DROP_TOO_BIG, DROP_LOSS, DROP_UNREACHABLE, DROP_REFUSED, DROP_CAUSES };
+
+/*
+ * Columns of the binary export, one int32 per node and tick each
+ */
+enum statColumn { COL_SENT, COL_RECV, COL_SENT_BYTES, COL_RECV_BYTES, COL_PUSHBACK, COL_DROP_TOO_BIG, COL_DROP_LOSS, COL_DROP_UNREACHABLE, COL_DROP_REFUSED, COL_DEPTH, STAT_COLUMNS };
+
+#define STATS_MAGIC "ENSTATS1"
+#define STATS_NAME_LEN 24
+
+/**
+ * Struct Name: stats_header
+ *
+ * DESCRIPTION: Start of a binary statistics file. It is followed by STAT_COLUMNS names of
+ * 				STATS_NAME_LEN bytes, then by each column in turn: nodes * ticks int32
+ * 				values, node by node, tick by tick within a node. Node k of the file is
+ * 				node id firstId + k.
+ */
+typedef struct stats_header {
+	char magic[8];
+	int32_t columns;
+	int32_t firstId;
+	int32_t nodes;
+	int32_t ticks;
+}stats_header;
+
+/**
+ * Struct Name: type_count
+ *
+ * DESCRIPTION: Traffic of one message type, as told apart by the network's classifier
+ */
+typedef struct type_count {
+	int sent;
+	long long sentBytes;
+	int recv;
+	long long recvBytes;
+}type_count;
+
+/**
+ * CLASS NAME: NetStats
+ *
+ * DESCRIPTION: Per node, per tick message counters.
+ * 				Rows are created for node ids as they show up and each row only
+ * 				grows up to the last tick in which that node sent or received,
+ * 				so memory follows the actual run instead of a fixed node/time grid.
+ */
+class NetStats {
+private:
+	struct tickCount {
+		int v[STAT_COLUMNS];
+	};
+	vector< vector<tickCount> > nodes;
+	// per node, per message type run totals
+	vector< vector<type_count> > types;
+	type_count &typeAt(int id, int type);
+	tickCount &at(int id, int time);
+	int get(int id, int time, statColumn col);
+public:
+	NetStats() {}
+	void addNode(int id);
+	void countSent(int id, int time, int bytes);
+	void countRecv(int id, int time, int bytes);
+	void countDrop(int id, int time, dropCause cause);
+	void setDepth(int id, int time, int depth);
+	void countTypeSent(int id, int type, int bytes);
+	void countTypeRecv(int id, int type, int bytes);
+	int getSent(int id, int time);
+	int getRecv(int id, int time);
+	int getDrops(int id, dropCause cause);
+	void countPushback(int id, int time);
+	int getPushbacks(int id);
+	type_count getTypeTotal(int type);
+	int exportBinary(const char *path, int firstId, int lastId, int ticks);
+	static const char *causeName(dropCause cause);
+	static const char *columnName(statColumn col);
+	virtual ~NetStats() {}
+};
+
+#endif /* NETSTATS_H_ */
@@ -9,13 +9,23 @@
 /**
  * constructor
  */
-Node::Node() {}
+Node::Node(): nodeHashCode(0), nodeHash(0), vnode(0) {}
 
 /**
  * constructor
  */
 Node::Node(Address address) {
 	this->nodeAddress = address;
+	this->vnode = 0;
+	computeHashCode();
+}
+
+/**
+ * constructor of virtual node vnode of the node at address
+ */
+Node::Node(Address address, int vnode) {
+	this->nodeAddress = address;
+	this->vnode = vnode;
 	computeHashCode();
 }
 
@@ -27,10 +37,17 @@ Node::~Node() {}
 /**
  * FUNCTION NAME: computeHashCode
  *
- * DESCRIPTION: This function computes the hash code of the node address
+ * DESCRIPTION: This function computes the hash code of the node address.
+ * 				Virtual nodes past the first hash the address with their number.
  */
 void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+	if ( vnode == 0 ) {
+		nodeHash = hashFunc(nodeAddress.addr);
+	}
+	else {
+		nodeHash = hashFunc(nodeAddress.getAddress() + "#" + to_string(vnode));
+	}
+	nodeHashCode = nodeHash%RING_SIZE;
 }
 
 /**
@@ -39,6 +56,8 @@ void Node::computeHashCode() {
 Node::Node(const Node& another) {
 	this->nodeAddress = another.nodeAddress;
 	this->nodeHashCode = another.nodeHashCode;
+	this->nodeHash = another.nodeHash;
+	this->vnode = another.vnode;
 }
 
 /**
@@ -47,6 +66,8 @@ Node::Node(const Node& another) {
 Node& Node::operator=(const Node& another) {
 	this->nodeAddress = another.nodeAddress;
 	this->nodeHashCode = another.nodeHashCode;
+	this->nodeHash = another.nodeHash;
+	this->vnode = another.vnode;
 	return *this;
 }
 
@@ -14,9 +14,14 @@ class Node {
 public:
 	Address nodeAddress;
 	size_t nodeHashCode;
+	// the whole hash nodeHashCode was cut from, orders nodes that share a ring position
+	size_t nodeHash;
+	// which of the node's virtual nodes this ring position is
+	int vnode;
 	std::hash<string> hashFunc;
 	Node();
 	Node(Address address);
+	Node(Address address, int vnode);
 	Node(const Node& another);
 	Node& operator=(const Node& another);
 	bool operator < (const Node& another) const;
@@ -19,6 +19,8 @@ Params::Params(): PORTNUM(8001) {}
 void Params::setparams(char *config_file) {
 	//trace.funcEntry("Params::setparams");
 	char CRUD[10];
+	char key[64];
+	char value[256];
 	FILE *fp = fopen(config_file,"r");
 
 	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
@@ -51,11 +53,162 @@ void Params::setparams(char *config_file) {
 	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
 		allNodesJoined += i;
 	}
+
+	// optional settings, one "KEY: value" per line after the fixed ones
+	LINK_DELAYS.clear();
+	NODE_BANDWIDTH = 0;
+	EN_THREADS = 1;
+	EN_BUFF_SIZE = ENBUFFSIZE;
+	TRANSPORT = TRANSPORT_MEMORY;
+	UDP_PORT = 20000;
+	SHM_RING = SHM_RING_SIZE;
+	SHM_PROCS = max(2, (int)sysconf(_SC_NPROCESSORS_ONLN));
+	SEED = (unsigned int)time(NULL);
+	STATS_EXPORT = 0;
+	GOSSIP_MODE = GOSSIP_FULL;
+	GOSSIP_DIGEST = 10;
+	GOSSIP_FANOUT = 1;
+	GOSSIP_RETRANSMIT = 1;
+	VNODES = 1;
+	MEMBER_CODEC = CODEC_RAW;
+	MEMBERSHIP = MEMBERSHIP_GOSSIP;
+	SWIM_PERIOD = 6;
+	SWIM_TIMEOUT = 2;
+	SWIM_K = 3;
+	SWIM_SUSPECT = 3;
+	FAILURE_DETECTOR = DETECTOR_FIXED;
+	PHI_THRESHOLD = 16;
+	PHI_WINDOW = 100;
+	PHI_MIN_SAMPLES = 5;
+	PHI_MIN_STDDEV = 1;
+	RUN_REPORT = 0;
+	while ( fscanf(fp, " %63[^:]: %255[^\n]", key, value) == 2 ) {
+		setoption(key, value);
+	}
 	fclose(fp);
 	//trace.funcExit("Params::setparams", SUCCESS);
 	return;
 }
 
+/**
+ * FUNCTION NAME: setoption
+ *
+ * DESCRIPTION: Apply one optional "KEY: value" setting from the test case file
+ */
+void Params::setoption(char *key, char *value) {
+	if ( 0 == strcmp(key, "LINK_DELAY") ) {
+		// LINK_DELAY: <from> <to> CONST|UNIFORM|EXP <a> [<b>]
+		LinkDelay ld;
+		char dist[16];
+		ld.b = 0;
+		if ( sscanf(value, "%d %d %15s %lf %lf", &ld.from, &ld.to, dist, &ld.a, &ld.b) < 4 ) {
+			return;
+		}
+		if ( 0 == strcmp(dist, "UNIFORM") ) {
+			ld.dist = DELAY_UNIFORM;
+		}
+		else if ( 0 == strcmp(dist, "EXP") ) {
+			ld.dist = DELAY_EXP;
+		}
+		else {
+			ld.dist = DELAY_CONST;
+		}
+		LINK_DELAYS.push_back(ld);
+	}
+	else if ( 0 == strcmp(key, "NODE_BANDWIDTH") ) {
+		NODE_BANDWIDTH = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "EN_THREADS") ) {
+		EN_THREADS = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "EN_BUFF_SIZE") ) {
+		EN_BUFF_SIZE = max(0, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "TRANSPORT") ) {
+		// TRANSPORT: MEMORY|UDP|SHM
+		if ( 0 == strcmp(value, "UDP") ) {
+			TRANSPORT = TRANSPORT_UDP;
+		}
+		else if ( 0 == strcmp(value, "SHM") ) {
+			TRANSPORT = TRANSPORT_SHM;
+		}
+		else {
+			TRANSPORT = TRANSPORT_MEMORY;
+		}
+	}
+	else if ( 0 == strcmp(key, "UDP_PORT") ) {
+		UDP_PORT = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "SHM_RING") ) {
+		SHM_RING = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "SHM_PROCS") ) {
+		SHM_PROCS = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "STATS_EXPORT") ) {
+		STATS_EXPORT = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "GOSSIP_MODE") ) {
+		// GOSSIP_MODE: FULL|DELTA
+		GOSSIP_MODE = ( 0 == strcmp(value, "DELTA") ) ? GOSSIP_DELTA : GOSSIP_FULL;
+	}
+	else if ( 0 == strcmp(key, "GOSSIP_DIGEST") ) {
+		GOSSIP_DIGEST = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "GOSSIP_FANOUT") ) {
+		GOSSIP_FANOUT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "GOSSIP_RETRANSMIT") ) {
+		GOSSIP_RETRANSMIT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "VNODES") ) {
+		VNODES = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "MEMBER_CODEC") ) {
+		// MEMBER_CODEC: RAW|PACKED
+		MEMBER_CODEC = ( 0 == strcmp(value, "PACKED") ) ? CODEC_PACKED : CODEC_RAW;
+	}
+	else if ( 0 == strcmp(key, "MEMBERSHIP") ) {
+		// MEMBERSHIP: GOSSIP|SWIM
+		MEMBERSHIP = ( 0 == strcmp(value, "SWIM") ) ? MEMBERSHIP_SWIM : MEMBERSHIP_GOSSIP;
+	}
+	else if ( 0 == strcmp(key, "SWIM_PERIOD") ) {
+		SWIM_PERIOD = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "SWIM_TIMEOUT") ) {
+		SWIM_TIMEOUT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "SWIM_K") ) {
+		SWIM_K = max(0, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "SWIM_SUSPECT") ) {
+		SWIM_SUSPECT = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "FAILURE_DETECTOR") ) {
+		// FAILURE_DETECTOR: FIXED|PHI
+		FAILURE_DETECTOR = ( 0 == strcmp(value, "PHI") ) ? DETECTOR_PHI : DETECTOR_FIXED;
+	}
+	else if ( 0 == strcmp(key, "PHI_THRESHOLD") ) {
+		// below log10(2) phi is reached before the mean gap, at 0 and under never
+		PHI_THRESHOLD = max(0.5, atof(value));
+	}
+	else if ( 0 == strcmp(key, "PHI_WINDOW") ) {
+		PHI_WINDOW = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "PHI_MIN_SAMPLES") ) {
+		PHI_MIN_SAMPLES = max(1, atoi(value));
+	}
+	else if ( 0 == strcmp(key, "PHI_MIN_STDDEV") ) {
+		PHI_MIN_STDDEV = max(0.0, atof(value));
+	}
+	else if ( 0 == strcmp(key, "RUN_REPORT") ) {
+		RUN_REPORT = atoi(value);
+	}
+	else if ( 0 == strcmp(key, "SEED") ) {
+		SEED = (unsigned int)strtoul(value, NULL, 10);
+	}
+}
+
 /**
  * FUNCTION NAME: getcurrtime
  *
@@ -11,7 +11,35 @@
 #include "Params.h"
 #include "Member.h"
 
+// default cap on messages in flight in an EmulNet
+#define ENBUFFSIZE 30000
+// default bytes of ring per process pair of the shared memory transport
+#define SHM_RING_SIZE (1 << 20)
+
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
+enum delayDist { DELAY_CONST, DELAY_UNIFORM, DELAY_EXP };
+enum transportType { TRANSPORT_MEMORY, TRANSPORT_UDP, TRANSPORT_SHM };
+enum gossipMode { GOSSIP_FULL, GOSSIP_DELTA };
+enum memberCodec { CODEC_RAW, CODEC_PACKED };
+enum membershipMode { MEMBERSHIP_GOSSIP, MEMBERSHIP_SWIM };
+enum failureDetector { DETECTOR_FIXED, DETECTOR_PHI };
+
+/**
+ * STRUCT NAME: LinkDelay
+ *
+ * DESCRIPTION: Delay distribution, in ticks, of the links from node "from" to node "to".
+ * 				0 in from/to matches any node.
+ * 				DELAY_CONST: a
+ * 				DELAY_UNIFORM: uniform in [a, b]
+ * 				DELAY_EXP: a plus an exponential with mean b
+ */
+typedef struct LinkDelay {
+	int from;
+	int to;
+	delayDist dist;
+	double a;
+	double b;
+}LinkDelay;
 
 /**
  * CLASS NAME: Params
@@ -32,8 +60,36 @@ public:
 	int allNodesJoined;
 	short PORTNUM;
 	int CRUDTEST;
+	vector<LinkDelay> LINK_DELAYS;	// per link delay distributions
+	int NODE_BANDWIDTH;			// egress bytes per tick per node, 0 for unlimited
+	int EN_THREADS;				// worker threads stepping the nodes
+	int EN_BUFF_SIZE;			// messages in flight before senders get pushed back, 0 for unlimited
+	int TRANSPORT;				// transportType carrying the messages
+	int UDP_PORT;				// first port of the UDP transport
+	int SHM_RING;				// bytes per process pair ring of the shared memory transport
+	int SHM_PROCS;				// processes the nodes are spread over with the shared memory transport
+	unsigned int SEED;			// run seed every random stream is drawn from
+	int STATS_EXPORT;			// write netstats<lane>.bin at the end of the run
+	int GOSSIP_MODE;			// gossipMode of MP1: whole list or changed entries only
+	int GOSSIP_DIGEST;			// delta gossip: every n-th round carries the whole list
+	int GOSSIP_FANOUT;			// gossip: peers sent to each round
+	int GOSSIP_RETRANSMIT;		// delta gossip: rounds a changed entry keeps being sent
+	int VNODES;					// ring positions, virtual nodes, of each member in MP2
+	int MEMBER_CODEC;			// memberCodec of the lists MP1 sends
+	int MEMBERSHIP;				// membershipMode of MP1: heartbeat gossip or SWIM probes
+	int SWIM_PERIOD;			// SWIM: ticks per protocol period, one probe each
+	int SWIM_TIMEOUT;			// SWIM: ticks to wait for a direct ack before asking others
+	int SWIM_K;					// SWIM: members asked to probe indirectly
+	int SWIM_SUSPECT;			// SWIM: protocol periods a suspect has to refute before removal
+	int FAILURE_DETECTOR;		// failureDetector of gossip mode: fixed timeout or phi accrual
+	double PHI_THRESHOLD;		// phi accrual: phi at which a member is removed
+	int PHI_WINDOW;				// phi accrual: inter-arrival gaps kept per member
+	int PHI_MIN_SAMPLES;		// phi accrual: gaps needed before phi replaces the fixed timeout
+	double PHI_MIN_STDDEV;		// phi accrual: floor on the gap deviation, in ticks
+	int RUN_REPORT;				// track detection, convergence and ownership and print them at the end
 	Params();
 	void setparams(char *);
+	void setoption(char *key, char *value);
 	int getcurrtime();
 };
 
@@ -0,0 +1,216 @@
+/**********************************
+ * FILE NAME: ProcGroup.cpp
+ *
+ * DESCRIPTION: Definition of the worker processes of a multi-process run
+ **********************************/
+
+#include "ProcGroup.h"
+
+/**
+ * Constructor
+ *
+ * Maps the control segment. If that fails the run stays in one process.
+ */
+ProcGroup::ProcGroup(int procs, int nodes): procs(max(1, procs)), self(0), nodes(max(1, nodes)), leaderPid(getpid()), control(NULL) {
+	control = (proc_control *)map("control", sizeof(proc_control));
+	if ( control == NULL ) {
+		this->procs = 1;
+	}
+}
+
+/**
+ * Destructor
+ */
+ProcGroup::~ProcGroup() {
+	unlinkAll();
+	for ( unsigned int i = 0; i < maps.size(); i++ ) {
+		munmap(maps[i].first, maps[i].second);
+	}
+}
+
+/**
+ * FUNCTION NAME: map
+ *
+ * DESCRIPTION: Create a zero filled shared segment of length bytes, named after the
+ * 				leader's pid and what. Call before start so that every process maps it.
+ *
+ * RETURNS:
+ * the mapping, NULL on failure
+ */
+void *ProcGroup::map(const string &what, size_t length) {
+	string name = "/dht-" + to_string(leaderPid) + "-" + what;
+	void *m = MAP_FAILED;
+
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if ( fd < 0 ) {
+		fprintf(stderr, "ProcGroup shm_open %s: %s\n", name.c_str(), strerror(errno));
+		return NULL;
+	}
+	if ( ftruncate(fd, length) == 0 ) {
+		m = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	if ( m == MAP_FAILED ) {
+		fprintf(stderr, "ProcGroup map %s: %s\n", name.c_str(), strerror(errno));
+		close(fd);
+		shm_unlink(name.c_str());
+		return NULL;
+	}
+	close(fd);
+	names.push_back(name);
+	maps.push_back(make_pair(m, length));
+	return m;
+}
+
+/**
+ * FUNCTION NAME: unlinkAll
+ *
+ * DESCRIPTION: Remove the names of the segments, the mappings stay valid
+ */
+void ProcGroup::unlinkAll() {
+	for ( unsigned int i = 0; i < names.size(); i++ ) {
+		shm_unlink(names[i].c_str());
+	}
+	names.clear();
+}
+
+/**
+ * FUNCTION NAME: start
+ *
+ * DESCRIPTION: Fork the workers 1 .. procs - 1; the caller carries on as process 0.
+ * 				A worker is killed if the leader dies. Returns in every process once
+ * 				all of them run.
+ */
+void ProcGroup::start() {
+	if ( procs <= 1 ) {
+		return;
+	}
+
+	// nothing buffered may be written twice
+	fflush(NULL);
+	for ( int p = 1; p < procs; p++ ) {
+		pid_t pid = fork();
+		if ( pid < 0 ) {
+			perror("ProcGroup fork");
+			control->failed = 1;
+			for ( unsigned int i = 0; i < children.size(); i++ ) {
+				kill(children[i], SIGKILL);
+			}
+			exit(1);
+		}
+		if ( pid == 0 ) {
+			self = p;
+			children.clear();
+			// the leader unlinks the names
+			names.clear();
+			prctl(PR_SET_PDEATHSIG, SIGKILL);
+			if ( getppid() != leaderPid ) {
+				_exit(1);
+			}
+			break;
+		}
+		children.push_back(pid);
+	}
+
+	barrier();
+	if ( leader() ) {
+		unlinkAll();
+	}
+}
+
+/**
+ * FUNCTION NAME: checkPeers
+ *
+ * DESCRIPTION: Give up if another process of the group died. The leader reaps a worker
+ * 				that exited, flags the group and kills the rest; workers leave once the
+ * 				group is flagged.
+ */
+void ProcGroup::checkPeers() {
+	if ( control->failed ) {
+		if ( leader() ) {
+			exit(1);
+		}
+		_exit(1);
+	}
+	if ( !leader() ) {
+		return;
+	}
+	for ( unsigned int i = 0; i < children.size(); i++ ) {
+		int status;
+		if ( waitpid(children[i], &status, WNOHANG) == children[i] ) {
+			fprintf(stderr, "ProcGroup worker %d stopped, giving up\n", i + 1);
+			control->failed = 1;
+			for ( unsigned int j = 0; j < children.size(); j++ ) {
+				kill(children[j], SIGKILL);
+			}
+			exit(1);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: barrier
+ *
+ * DESCRIPTION: Wait until every process of the group has called barrier as often as
+ * 				this one. Whatever a process wrote to shared memory before is visible
+ * 				to all of them after.
+ */
+void ProcGroup::barrier() {
+	if ( procs <= 1 ) {
+		return;
+	}
+
+	int round = control->round.load(memory_order_acquire);
+	if ( control->arrived.fetch_add(1, memory_order_acq_rel) + 1 == procs ) {
+		control->arrived.store(0, memory_order_relaxed);
+		control->round.store(round + 1, memory_order_release);
+		return;
+	}
+	for ( long spins = 0; control->round.load(memory_order_acquire) == round; spins++ ) {
+		if ( spins < 1000 ) {
+			this_thread::yield();
+			continue;
+		}
+		usleep(20);
+		if ( spins % 1000 == 0 ) {
+			checkPeers();
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: share
+ *
+ * DESCRIPTION: Copy size bytes of data from process from to data in every other process.
+ * 				All processes must call it together.
+ */
+void ProcGroup::share(int from, void *data, int size) {
+	if ( procs <= 1 ) {
+		return;
+	}
+
+	assert(size <= PROC_SHARE_BYTES);
+	if ( self == from ) {
+		memcpy(control->share, data, size);
+		control->shareSize = size;
+	}
+	barrier();
+	if ( self != from ) {
+		memcpy(data, control->share, min(size, control->shareSize));
+	}
+	barrier();
+}
+
+/**
+ * FUNCTION NAME: finish
+ *
+ * DESCRIPTION: In the leader, wait for every worker to exit at the end of the run
+ */
+void ProcGroup::finish() {
+	for ( unsigned int i = 0; i < children.size(); i++ ) {
+		int status;
+		if ( waitpid(children[i], &status, 0) == children[i] && !(WIFEXITED(status) && WEXITSTATUS(status) == 0) ) {
+			fprintf(stderr, "ProcGroup worker %d did not finish cleanly\n", i + 1);
+		}
+	}
+	children.clear();
+}
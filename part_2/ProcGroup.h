@@ -0,0 +1,97 @@
+/**********************************
+ * FILE NAME: ProcGroup.h
+ *
+ * DESCRIPTION: Header file of the worker processes of a multi-process run
+ **********************************/
+
+#ifndef PROCGROUP_H_
+#define PROCGROUP_H_
+
+#include "stdincludes.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <signal.h>
+#include <errno.h>
+
+// bytes one process can hand the others at a time with share
+#define PROC_SHARE_BYTES 4096
+
+/**
+ * Struct Name: proc_control
+ *
+ * DESCRIPTION: Control segment shared by all processes of a group
+ */
+typedef struct proc_control {
+	// processes waiting at the current barrier
+	atomic<int> arrived;
+	// bumped every time a barrier opens
+	atomic<int> round;
+	// set once a process died, the others give up
+	atomic<int> failed;
+	int shareSize;
+	char share[PROC_SHARE_BYTES];
+}proc_control;
+
+/**
+ * CLASS NAME: ProcGroup
+ *
+ * DESCRIPTION: A run split over several processes.
+ * 				The process that creates the group maps the shared segments, then start
+ * 				forks the workers. Every process owns a contiguous range of node indices
+ * 				and steps only those nodes; all of them run the same tick loop and meet
+ * 				at barriers between phases. The segments keep their names until every
+ * 				worker is running and are unlinked then, so nothing stays behind in
+ * 				/dev/shm. If a process dies the others stop instead of waiting for it.
+ */
+class ProcGroup {
+private:
+	int procs;
+	int self;
+	int nodes;
+	pid_t leaderPid;
+	vector<pid_t> children;
+	proc_control *control;
+	// names still linked, and every mapping of the group
+	vector<string> names;
+	vector< pair<void *, size_t> > maps;
+	void unlinkAll();
+	void checkPeers();
+public:
+	ProcGroup(int procs, int nodes);
+	virtual ~ProcGroup();
+	ProcGroup(const ProcGroup &) = delete;
+	ProcGroup& operator = (const ProcGroup &) = delete;
+	void *map(const string &what, size_t length);
+	void start();
+	void barrier();
+	void share(int from, void *data, int size);
+	void finish();
+	int size() {
+		return procs;
+	}
+	int index() {
+		return self;
+	}
+	bool leader() {
+		return self == 0;
+	}
+	// process stepping node index i
+	int ownerOf(int i) {
+		return (int)((long)i * procs / nodes);
+	}
+	// process stepping the node with address id, ids start at 1
+	int ownerOfId(int id) {
+		return ownerOf(id - 1);
+	}
+	bool owns(int i) {
+		return ownerOf(i) == self;
+	}
+	// first node index of process p, firstNode(p + 1) is one past its last
+	int firstNode(int p) {
+		return (int)(((long)p * nodes + procs - 1) / procs);
+	}
+};
+
+#endif /* PROCGROUP_H_ */
@@ -0,0 +1,81 @@
+/**********************************
+ * FILE NAME: Random.h
+ *
+ * DESCRIPTION: Seeded pseudo random number streams
+ **********************************/
+
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include "stdincludes.h"
+#include <stdint.h>
+
+/*
+ * Kinds of stream drawn from the run seed
+ */
+#define RNG_APP 0
+#define RNG_MP1 1
+#define RNG_NET 2
+#define RNG_LINK 3
+
+/**
+ * CLASS NAME: Random
+ *
+ * DESCRIPTION: xoshiro256** generator.
+ * 				Each user owns its own instance, seeded from the run seed and a stream
+ * 				key, so runs are reproducible and nodes stepped on different threads never
+ * 				share generator state. Streams with different keys are independent.
+ */
+class Random {
+private:
+	uint64_t s[4];
+	static uint64_t rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+	// splitmix64, expands one word of seed into the state
+	static uint64_t mix(uint64_t &x) {
+		uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+public:
+	Random() {
+		seed(0, 0);
+	}
+	Random(uint64_t seed, uint64_t stream) {
+		this->seed(seed, stream);
+	}
+	// key of stream "kind" for one node, e.g. streamOf(RNG_NET, lane, id)
+	static uint64_t streamOf(int kind, int lane, int id) {
+		return ((uint64_t)kind << 48) | ((uint64_t)(lane & 0xFFFF) << 32) | (uint32_t)id;
+	}
+	void seed(uint64_t seed, uint64_t stream) {
+		uint64_t x = seed;
+		x = mix(x) ^ stream;
+		for ( int i = 0; i < 4; i++ ) {
+			s[i] = mix(x);
+		}
+	}
+	uint64_t next() {
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+	// uniform in [0, n)
+	int nextInt(int n) {
+		return (int)(((next() >> 32) * (uint64_t)n) >> 32);
+	}
+	// uniform in (0, 1)
+	double nextDouble() {
+		return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+	}
+};
+
+#endif /* RANDOM_H_ */
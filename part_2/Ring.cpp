@@ -0,0 +1,222 @@
+/**********************************
+ * FILE NAME: Ring.cpp
+ *
+ * DESCRIPTION: Definition of the consistent hashing ring
+ **********************************/
+
+#include "Ring.h"
+
+/**
+ * FUNCTION NAME: before
+ *
+ * DESCRIPTION: Ring order: by hash code, then by the whole hash, so that which of the nodes
+ * 				sharing a position comes first (and is primary there) does not depend on
+ * 				their addresses, then by address and virtual node
+ */
+bool Ring::before(const Node &a, const Node &b) {
+	if ( a.nodeHashCode != b.nodeHashCode ) {
+		return a.nodeHashCode < b.nodeHashCode;
+	}
+	if ( a.nodeHash != b.nodeHash ) {
+		return a.nodeHash < b.nodeHash;
+	}
+	int c = memcmp(a.nodeAddress.addr, b.nodeAddress.addr, sizeof(a.nodeAddress.addr));
+	if ( c != 0 ) {
+		return c < 0;
+	}
+	return a.vnode < b.vnode;
+}
+
+/**
+ * FUNCTION NAME: setVnodes
+ *
+ * DESCRIPTION: Positions each member takes on the ring. Set it while the ring is empty.
+ */
+void Ring::setVnodes(int count) {
+	vnodes = max(1, count);
+}
+
+/**
+ * FUNCTION NAME: lowerBound
+ *
+ * DESCRIPTION: Slot of the first node that is not before node
+ */
+int Ring::lowerBound(const Node &node) {
+	return lower_bound(nodes.begin(), nodes.end(), node, before) - nodes.begin();
+}
+
+/**
+ * FUNCTION NAME: assign
+ *
+ * DESCRIPTION: Build the ring from scratch out of the given members
+ */
+void Ring::assign(const vector<Node> &members) {
+	nodes.clear();
+	for ( unsigned int i = 0; i < members.size(); i++ ) {
+		for ( int v = 0; v < vnodes; v++ ) {
+			nodes.push_back(Node(members[i].nodeAddress, v));
+		}
+	}
+	sort(nodes.begin(), nodes.end(), before);
+	positions.resize(nodes.size());
+	for ( unsigned int i = 0; i < nodes.size(); i++ ) {
+		positions[i] = nodes[i].nodeHashCode;
+	}
+	stale = true;
+}
+
+/**
+ * FUNCTION NAME: insert
+ *
+ * DESCRIPTION: Put the virtual nodes of the member at addr in their places on the ring
+ *
+ * RETURNS:
+ * false if it was already there
+ */
+bool Ring::insert(Address &addr) {
+	if ( find(addr) >= 0 ) {
+		return false;
+	}
+	for ( int v = 0; v < vnodes; v++ ) {
+		Node node(addr, v);
+		int i = lowerBound(node);
+		nodes.insert(nodes.begin() + i, node);
+		positions.insert(positions.begin() + i, node.nodeHashCode);
+	}
+	stale = true;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: erase
+ *
+ * DESCRIPTION: Take the virtual nodes of the member at addr off the ring
+ *
+ * RETURNS:
+ * false if it was not there
+ */
+bool Ring::erase(Address &addr) {
+	if ( find(addr) < 0 ) {
+		return false;
+	}
+	for ( int v = 0; v < vnodes; v++ ) {
+		Node node(addr, v);
+		int i = lowerBound(node);
+		if ( i < (int)nodes.size() && !before(node, nodes[i]) ) {
+			nodes.erase(nodes.begin() + i);
+			positions.erase(positions.begin() + i);
+		}
+	}
+	stale = true;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Slot of virtual node 0 of the member at addr, the position of its address
+ * 				hash, which need not come first on the ring; -1 if it is not on the ring
+ */
+int Ring::find(Address &addr) {
+	Node node(addr);
+	int i = lowerBound(node);
+	if ( i < (int)nodes.size() && !before(node, nodes[i]) ) {
+		return i;
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: neighbors
+ *
+ * DESCRIPTION: The count nodes before self on the ring, farthest first, and the count
+ * 				nodes after it, nearest first. Both are empty if self is not on the ring.
+ * 				On a ring of fewer than count + 1 nodes they wrap around.
+ */
+void Ring::neighbors(Address &self, int count, vector<Node> &pred, vector<Node> &succ) {
+	int n = nodes.size();
+	int i = find(self);
+
+	pred.clear();
+	succ.clear();
+	if ( i < 0 ) {
+		return;
+	}
+	for ( int k = count; k >= 1; k-- ) {
+		pred.push_back(nodes[((i - k) % n + n) % n]);
+	}
+	for ( int k = 1; k <= count; k++ ) {
+		succ.push_back(nodes[(i + k) % n]);
+	}
+}
+
+/**
+ * FUNCTION NAME: successor
+ *
+ * DESCRIPTION: Slot of the first node at or after ring position pos, wrapping around
+ * 				past the last one; -1 on an empty ring
+ */
+int Ring::successor(size_t pos) {
+	if ( positions.empty() ) {
+		return -1;
+	}
+	int i = lower_bound(positions.begin(), positions.end(), pos) - positions.begin();
+	return ( i == (int)positions.size() ) ? 0 : i;
+}
+
+/**
+ * FUNCTION NAME: replicasOf
+ *
+ * DESCRIPTION: Replica set of the keys at ring position pos. The reference stays valid
+ * 				until the ring next changes.
+ */
+const replica_set &Ring::replicasOf(size_t pos) {
+	static const replica_set none = replica_set();
+	int n = nodes.size();
+
+	if ( n < REPLICAS ) {
+		return none;
+	}
+	if ( stale ) {
+		sets.resize(n);
+		for ( int i = 0; i < n; i++ ) {
+			// walk on from slot i, skipping further virtual nodes of members already taken
+			replica_set &set = sets[i];
+			set.count = 0;
+			for ( int k = 0; k < n && set.count < REPLICAS; k++ ) {
+				Node &node = nodes[(i + k) % n];
+				bool taken = false;
+				for ( int j = 0; j < set.count && !taken; j++ ) {
+					taken = memcmp(set.node[j].nodeAddress.addr, node.nodeAddress.addr, sizeof(node.nodeAddress.addr)) == 0;
+				}
+				if ( !taken ) {
+					set.node[set.count++] = node;
+				}
+			}
+			if ( set.count < REPLICAS ) {
+				set.count = 0;
+			}
+		}
+		stale = false;
+	}
+	return sets[successor(pos)];
+}
+
+/**
+ * FUNCTION NAME: ownership
+ *
+ * DESCRIPTION: Ring positions each member is the primary of, by address, adding to share.
+ * 				Members that own none are still listed.
+ */
+void Ring::ownership(map<string, int> &share) {
+	int n = nodes.size();
+
+	for ( int i = 0; i < n; i++ ) {
+		share[nodes[i].nodeAddress.getAddress()] += 0;
+	}
+	for ( int i = 0; i < n; i++ ) {
+		// a node is the primary of the positions after the one before it, up to its own
+		int from = ( i == 0 ) ? (int)positions[n - 1] - RING_SIZE : (int)positions[i - 1];
+		share[nodes[i].nodeAddress.getAddress()] += (int)positions[i] - from;
+	}
+}
@@ -0,0 +1,80 @@
+/**********************************
+ * FILE NAME: Ring.h
+ *
+ * DESCRIPTION: Header file of the consistent hashing ring
+ **********************************/
+
+#ifndef RING_H_
+#define RING_H_
+
+#include "stdincludes.h"
+#include "Node.h"
+
+/*
+ * Neighbors of a node that changed when the ring did
+ */
+enum ringEvent { RING_PREDECESSORS = 1, RING_SUCCESSORS = 2 };
+
+// copies of every key: the primary and the nodes after it on the ring
+#define REPLICAS 3
+
+/**
+ * Struct Name: replica_set
+ *
+ * DESCRIPTION: The nodes holding the keys of one ring segment, primary first.
+ * 				count is 0 on a ring of fewer than REPLICAS nodes.
+ */
+typedef struct replica_set {
+	Node node[REPLICAS];
+	int count;
+}replica_set;
+
+/**
+ * CLASS NAME: Ring
+ *
+ * DESCRIPTION: The nodes of the DHT in ring order, kept as a sorted flat array.
+ * 				Every member takes vnodes positions, its virtual nodes; a replica
+ * 				set is made of the first REPLICAS distinct members from a position on.
+ * 				A join or leave finds its place by binary search and shifts the
+ * 				rest of the array, so membership deltas are applied without
+ * 				sorting the whole ring again. Nodes whose hash codes collide are
+ * 				ordered by their whole hash, so every node sees the same ring.
+ * 				Key lookups binary search a separate array of the nodes' positions
+ * 				and return the replica set of the segment from a cache that is
+ * 				rebuilt on the first lookup after the ring changed.
+ */
+class Ring {
+private:
+	vector<Node> nodes;
+	// hash codes of nodes, slot for slot
+	vector<size_t> positions;
+	// replica set of the segment ending at each slot, valid while !stale
+	vector<replica_set> sets;
+	bool stale;
+	int vnodes;
+	static bool before(const Node &a, const Node &b);
+	int lowerBound(const Node &node);
+public:
+	Ring(): stale(true), vnodes(1) {}
+	void setVnodes(int count);
+	void assign(const vector<Node> &members);
+	bool insert(Address &addr);
+	bool erase(Address &addr);
+	int find(Address &addr);
+	void neighbors(Address &self, int count, vector<Node> &pred, vector<Node> &succ);
+	int successor(size_t pos);
+	const replica_set &replicasOf(size_t pos);
+	void ownership(map<string, int> &share);
+	int size() {
+		return nodes.size();
+	}
+	Node &at(int i) {
+		return nodes.at(i);
+	}
+	Node &operator [](int i) {
+		return nodes[i];
+	}
+	virtual ~Ring() {}
+};
+
+#endif /* RING_H_ */
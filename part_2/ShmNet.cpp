@@ -0,0 +1,160 @@
+/**********************************
+ * FILE NAME: ShmNet.cpp
+ *
+ * DESCRIPTION: Definition of the shared memory ring transport
+ **********************************/
+
+#include "ShmNet.h"
+
+/**
+ * Constructor
+ *
+ * Maps, through the group, one segment holding a ring for every ordered pair of its
+ * processes. Must run before the group starts its workers.
+ */
+ShmNet::ShmNet(Params *p, int lane, ProcGroup *group): EmulNet(p, lane), group(group), base(NULL) {
+	unsigned int want = max((unsigned int)p->SHM_RING, 2 * (unsigned int)(p->MAX_MSG_SIZE + SHM_RECORD_INTS * sizeof(int)));
+
+	procs = group->size();
+	for ( ringBytes = 64; ringBytes < want; ringBytes <<= 1 ) {}
+	if ( procs > 1 ) {
+		// the segment comes zero filled, which is the empty state of every ring
+		base = (char *)group->map("lane" + to_string(lane), (size_t)procs * procs * (sizeof(shm_ring) + ringBytes));
+	}
+}
+
+/**
+ * Destructor
+ *
+ * The group unmaps the segment.
+ */
+ShmNet::~ShmNet() {}
+
+/**
+ * FUNCTION NAME: ringOf
+ *
+ * DESCRIPTION: Ring carrying messages from process from to process to
+ */
+shm_ring *ShmNet::ringOf(int from, int to) {
+	return (shm_ring *)(base + ((size_t)from * procs + to) * (sizeof(shm_ring) + ringBytes));
+}
+
+/**
+ * FUNCTION NAME: dataOf
+ *
+ * DESCRIPTION: Payload bytes of a ring, right after its header
+ */
+char *ShmNet::dataOf(shm_ring *r) {
+	return (char *)(r + 1);
+}
+
+/**
+ * FUNCTION NAME: post
+ *
+ * DESCRIPTION: Put an accepted frame on its way to node dst.
+ * 				A node of this process gets it in its shard directly. For a node of
+ * 				another process the frame is copied into the ring towards that process
+ * 				and released; the payload of a shared ENsendMulti body is patched on
+ * 				the way in.
+ *
+ * RETURNS:
+ * false if the ring is full
+ */
+bool ShmNet::post(int src, int dst, ENshard *shard, en_frame *f) {
+	int to = group->ownerOfId(dst);
+
+	if ( to == group->index() ) {
+		shard->incoming.push(f);
+		return true;
+	}
+	if ( base == NULL ) {
+		return false;
+	}
+
+	shm_ring *r = ringOf(group->index(), to);
+	char *data = dataOf(r);
+	en_frame *b = f->body ? f->body : f;
+	int size = b->msg.size;
+	unsigned int head = SHM_RECORD_INTS * sizeof(int);
+	unsigned int rec = head + ((size + 3) & ~3);
+	unsigned int h = r->head.load(memory_order_relaxed);
+	unsigned int t = r->tail.load(memory_order_acquire);
+	unsigned int off = h & (ringBytes - 1);
+	unsigned int contig = ringBytes - off;
+	// a record never wraps, the tail end of the ring is skipped instead
+	unsigned int need = ( rec > contig ) ? contig + rec : rec;
+
+	if ( ringBytes - (h - t) < need ) {
+		return false;
+	}
+	if ( rec > contig ) {
+		*(int *)(data + off) = -1;
+		h += contig;
+		off = 0;
+	}
+
+	int *ints = (int *)(data + off);
+	ints[0] = size;
+	ints[1] = f->due;
+	ints[2] = (int)f->seq;
+	ints[3] = src;
+	ints[4] = dst;
+	memcpy(data + off + head, (char *)(b + 1), size);
+	if ( f->body && f->patchAt >= 0 ) {
+		data[off + head + f->patchAt] = f->patch;
+	}
+	r->head.store(h + rec, memory_order_release);
+
+	// the receiving process counts it from here on
+	releaseFrame(f);
+	emulnet.currbuffsize--;
+	return true;
+}
+
+/**
+ * FUNCTION NAME: collect
+ *
+ * DESCRIPTION: Copy the records waiting in every ring towards this process into frames
+ * 				in the shards of their destinations, where they count as in flight again.
+ * 				The first node of the process to receive collects for all of them.
+ */
+void ShmNet::collect(int dst, ENshard *shard) {
+	if ( base == NULL ) {
+		return;
+	}
+
+	for ( int from = 0; from < procs; from++ ) {
+		if ( from == group->index() ) {
+			continue;
+		}
+		shm_ring *r = ringOf(from, group->index());
+		unsigned int t = r->tail.load(memory_order_relaxed);
+		unsigned int h = r->head.load(memory_order_acquire);
+		char *data = dataOf(r);
+
+		while ( t != h ) {
+			unsigned int off = t & (ringBytes - 1);
+			int *ints = (int *)(data + off);
+			int size = ints[0];
+			if ( size < 0 ) {
+				t += ringBytes - off;
+				continue;
+			}
+			ENshard *to = emulnet.shardOf(ints[4]);
+			if ( to != NULL ) {
+				en_frame *f = newFrame(size);
+				f->due = ints[1];
+				f->seq = (unsigned int)ints[2];
+				*(int *)(f->msg.from.addr) = ints[3];
+				*(short *)(&f->msg.from.addr[4]) = 0;
+				*(int *)(f->msg.to.addr) = ints[4];
+				*(short *)(&f->msg.to.addr[4]) = 0;
+				memcpy((char *)(f + 1), data + off + SHM_RECORD_INTS * sizeof(int), size);
+				emulnet.reserve(0);
+				to->incoming.push(f);
+			}
+			t += SHM_RECORD_INTS * sizeof(int) + ((size + 3) & ~3);
+		}
+		r->tail.store(t, memory_order_release);
+	}
+}
@@ -0,0 +1,66 @@
+/**********************************
+ * FILE NAME: ShmNet.h
+ *
+ * DESCRIPTION: Header file of the shared memory ring transport
+ **********************************/
+
+#ifndef SHMNET_H_
+#define SHMNET_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include "ProcGroup.h"
+
+/**
+ * Struct Name: shm_ring
+ *
+ * DESCRIPTION: Single producer, single consumer byte ring living in the shared segment.
+ * 				Records are [int len][int due][int seq][int src][int dst][len bytes of
+ * 				payload], 4 byte aligned; a negative len tells the consumer to skip to
+ * 				the start of the ring. head and tail only grow and sit on their own
+ * 				cache lines.
+ */
+typedef struct shm_ring {
+	// next byte the producer writes
+	atomic<unsigned int> head;
+	char pad1[64 - sizeof(atomic<unsigned int>)];
+	// next byte the consumer reads
+	atomic<unsigned int> tail;
+	char pad2[64 - sizeof(atomic<unsigned int>)];
+}shm_ring;
+
+// ints ahead of the payload in a ring record
+#define SHM_RECORD_INTS 5
+
+/**
+ * CLASS NAME: ShmNet
+ *
+ * DESCRIPTION: EmulNet for a run split over the processes of a ProcGroup.
+ * 				Messages between nodes of the same process go through memory as usual;
+ * 				messages to a node of another process go through the SPSC ring of that
+ * 				ordered pair of processes in a shared segment, so memory grows with the
+ * 				square of the processes, not of the nodes. Each process has one thread
+ * 				stepping its nodes, the only producer of its outgoing rings and the only
+ * 				consumer of its incoming ones. A full ring pushes back on the sender.
+ * 				A message counts against EN_BUFF_SIZE in the process holding it, not
+ * 				while it is in a ring. Drops, link delays and statistics are the same as
+ * 				in memory.
+ */
+class ShmNet : public EmulNet {
+private:
+	ProcGroup *group;
+	char *base;
+	int procs;
+	// payload bytes per ring, a power of two
+	unsigned int ringBytes;
+	shm_ring *ringOf(int from, int to);
+	char *dataOf(shm_ring *r);
+protected:
+	bool post(int src, int dst, ENshard *shard, en_frame *f);
+	void collect(int dst, ENshard *shard);
+public:
+	ShmNet(Params *p, int lane, ProcGroup *group);
+	virtual ~ShmNet();
+};
+
+#endif /* SHMNET_H_ */
@@ -0,0 +1,126 @@
+/**********************************
+ * FILE NAME: TimingWheel.h
+ *
+ * DESCRIPTION: Hierarchical timing wheel keyed by simulation tick
+ **********************************/
+
+#ifndef TIMINGWHEEL_H_
+#define TIMINGWHEEL_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+
+/**
+ * CLASS NAME: TimingWheel
+ *
+ * DESCRIPTION: Holds items until the tick they are due.
+ * 				Level 0 has one slot per tick for the next 64 ticks, each higher level
+ * 				covers 64 times the range of the one below. Scheduling is O(1) and
+ * 				advancing by one tick touches one slot per level that wraps, so the
+ * 				cost is independent of the number of pending items.
+ */
+template <class T>
+class TimingWheel {
+private:
+	struct timer {
+		long due;
+		T item;
+	};
+	vector<timer> slots[WHEEL_LEVELS][WHEEL_SLOTS];
+	// every item due at or before now has been handed out
+	long now;
+	long pending;
+
+	void place(const timer &t) {
+		long delta = t.due - now;
+		int level = 0;
+		while ( level < WHEEL_LEVELS - 1 && delta >= (1L << (WHEEL_BITS * (level + 1))) ) {
+			level++;
+		}
+		slots[level][(t.due >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)].push_back(t);
+	}
+
+	void cascade(int level) {
+		vector<timer> moved;
+		moved.swap(slots[level][(now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)]);
+		for ( unsigned int i = 0; i < moved.size(); i++ ) {
+			place(moved[i]);
+		}
+	}
+
+public:
+	TimingWheel(long start = 0): now(start), pending(0) {}
+
+	long getNow() {
+		return now;
+	}
+
+	long size() {
+		return pending;
+	}
+
+	/**
+	 * FUNCTION NAME: schedule
+	 *
+	 * DESCRIPTION: Add an item that becomes due at tick due (> now)
+	 */
+	void schedule(long due, const T &item) {
+		assert(due > now);
+		timer t = { due, item };
+		place(t);
+		pending++;
+	}
+
+	/**
+	 * FUNCTION NAME: advance
+	 *
+	 * DESCRIPTION: Move the wheel forward to tick to and append every item that
+	 * 				became due on the way to expired, in due order
+	 */
+	void advance(long to, vector<T> &expired) {
+		while ( now < to ) {
+			now++;
+			for ( int level = 1; level < WHEEL_LEVELS; level++ ) {
+				if ( (now & ((1L << (WHEEL_BITS * level)) - 1)) != 0 ) {
+					break;
+				}
+				cascade(level);
+			}
+			if ( pending == 0 ) {
+				now = to;
+				break;
+			}
+			vector<timer> &slot = slots[0][now & (WHEEL_SLOTS - 1)];
+			for ( unsigned int i = 0; i < slot.size(); i++ ) {
+				expired.push_back(slot[i].item);
+			}
+			pending -= slot.size();
+			slot.clear();
+		}
+	}
+
+	/**
+	 * FUNCTION NAME: drain
+	 *
+	 * DESCRIPTION: Remove every pending item regardless of its due tick
+	 */
+	void drain(vector<T> &items) {
+		for ( int level = 0; level < WHEEL_LEVELS; level++ ) {
+			for ( int i = 0; i < WHEEL_SLOTS; i++ ) {
+				for ( unsigned int j = 0; j < slots[level][i].size(); j++ ) {
+					items.push_back(slots[level][i][j].item);
+				}
+				slots[level][i].clear();
+			}
+		}
+		pending = 0;
+	}
+};
+
+#endif /* TIMINGWHEEL_H_ */
@@ -0,0 +1,279 @@
+/**********************************
+ * FILE NAME: UdpNet.cpp
+ *
+ * DESCRIPTION: Definition of the UDP loopback transport
+ **********************************/
+
+#include "UdpNet.h"
+
+/**
+ * Constructor
+ *
+ * Lanes get disjoint port ranges: lane l uses UDP_PORT + l * (EN_GPSZ + 1) + id.
+ */
+UdpNet::UdpNet(Params *p, int lane): EmulNet(p, lane), portBase(p->UDP_PORT + lane * (p->EN_GPSZ + 1)), flushing(0) {}
+
+/**
+ * Destructor
+ */
+UdpNet::~UdpNet() {
+	for ( unsigned int i = 0; i < fds.size(); i++ ) {
+		if ( fds[i] >= 0 ) {
+			close(fds[i]);
+		}
+		delete outboxes[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: ENattach
+ *
+ * DESCRIPTION: Set up the per node state and bind the node's socket to portBase + id.
+ * 				A node whose socket cannot be set up stays attached, but everything it
+ * 				sends is dropped and it never receives.
+ */
+void UdpNet::ENattach(Address *myaddr) {
+	int id = *(int *)(myaddr->addr);
+	struct sockaddr_in sa;
+	int rcvbuf = 1 << 22;
+
+	EmulNet::ENattach(myaddr);
+	while ( id >= (int)fds.size() ) {
+		fds.push_back(-1);
+		outboxes.push_back(new outbox());
+	}
+
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if ( fd < 0 ) {
+		perror("UdpNet socket");
+		return;
+	}
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	sa.sin_port = htons(portBase + id);
+	if ( bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 ) {
+		fprintf(stderr, "UdpNet bind port %d: %s\n", portBase + id, strerror(errno));
+		close(fd);
+		return;
+	}
+	fds[id] = fd;
+}
+
+/**
+ * FUNCTION NAME: post
+ *
+ * DESCRIPTION: Queue an accepted frame in its sender's outbox, sending the batch once it is full
+ */
+bool UdpNet::post(int src, int dst, ENshard *shard, en_frame *f) {
+	outbox *ob = outboxes[src];
+	bool full;
+
+	countRefused(src);
+	{
+		lock_guard<mutex> guard(ob->lock);
+		if ( ob->frames.empty() ) {
+			lock_guard<mutex> dirtyGuard(dirtyLock);
+			dirty.push_back(src);
+		}
+		ob->frames.push_back(make_pair(dst, f));
+		full = ob->frames.size() >= UDP_BATCH;
+	}
+	if ( full ) {
+		flush(src);
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Send everything in node src's outbox with sendmmsg.
+ * 				A datagram carries the due tick and the sender's sequence number followed
+ * 				by the payload; the payload of a shared ENsendMulti body is gathered
+ * 				around its patched byte, not copied.
+ * 				Datagrams the kernel refuses are lost and count as drops. Any thread may
+ * 				flush any outbox, so the drops are only noted here and counted by the
+ * 				sender's own thread.
+ * 				Once the kernel has a datagram it no longer counts as in flight.
+ */
+void UdpNet::flush(int src) {
+	outbox *ob = outboxes[src];
+	struct mmsghdr msgs[UDP_BATCH];
+	struct iovec iov[UDP_BATCH][5];
+	struct sockaddr_in to[UDP_BATCH];
+	unsigned int done = 0;
+
+	lock_guard<mutex> guard(ob->lock);
+	while ( done < ob->frames.size() ) {
+		int n = min((int)(ob->frames.size() - done), UDP_BATCH);
+
+		memset(msgs, 0, n * sizeof(struct mmsghdr));
+		for ( int i = 0; i < n; i++ ) {
+			en_frame *f = ob->frames[done + i].second;
+			en_frame *b = f->body ? f->body : f;
+			char *payload = (char *)(b + 1);
+			int size = b->msg.size;
+			int parts = 0;
+
+			iov[i][parts].iov_base = &f->due;
+			iov[i][parts++].iov_len = sizeof(f->due);
+			iov[i][parts].iov_base = &f->seq;
+			iov[i][parts++].iov_len = sizeof(f->seq);
+			if ( f->body && f->patchAt >= 0 ) {
+				iov[i][parts].iov_base = payload;
+				iov[i][parts++].iov_len = f->patchAt;
+				iov[i][parts].iov_base = &f->patch;
+				iov[i][parts++].iov_len = 1;
+				iov[i][parts].iov_base = payload + f->patchAt + 1;
+				iov[i][parts++].iov_len = size - f->patchAt - 1;
+			}
+			else {
+				iov[i][parts].iov_base = payload;
+				iov[i][parts++].iov_len = size;
+			}
+
+			memset(&to[i], 0, sizeof(to[i]));
+			to[i].sin_family = AF_INET;
+			to[i].sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			to[i].sin_port = htons(portBase + ob->frames[done + i].first);
+
+			msgs[i].msg_hdr.msg_name = &to[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(to[i]);
+			msgs[i].msg_hdr.msg_iov = iov[i];
+			msgs[i].msg_hdr.msg_iovlen = parts;
+		}
+
+		int sent = sendmmsg(fds[src], msgs, n, MSG_DONTWAIT);
+		if ( sent < 0 ) {
+			sent = 0;
+		}
+		for ( int i = 0; i < sent; i++ ) {
+			releaseFrame(ob->frames[done + i].second);
+			emulnet.currbuffsize--;
+		}
+		// skip the datagram that failed and carry on with the rest
+		if ( sent < n ) {
+			releaseFrame(ob->frames[done + sent].second);
+			emulnet.currbuffsize--;
+			ob->refused.push_back(par->getcurrtime());
+			sent++;
+		}
+		done += sent;
+	}
+	ob->frames.clear();
+}
+
+/**
+ * FUNCTION NAME: countRefused
+ *
+ * DESCRIPTION: Count the datagrams of node src the kernel refused as drops of src.
+ * 				Called from src's own thread only, which alone writes src's statistics.
+ */
+void UdpNet::countRefused(int src) {
+	outbox *ob = outboxes[src];
+	vector<int> refused;
+	{
+		lock_guard<mutex> guard(ob->lock);
+		if ( ob->refused.empty() ) {
+			return;
+		}
+		refused.swap(ob->refused);
+	}
+	for ( unsigned int i = 0; i < refused.size(); i++ ) {
+		stats.countDrop(src, refused[i], DROP_REFUSED);
+	}
+}
+
+/**
+ * FUNCTION NAME: flushAll
+ *
+ * DESCRIPTION: Send what every sender has queued so far, and wait for the flushes other
+ * 				threads are in the middle of, so that everything sent before this node
+ * 				receives is on its socket whichever thread took it off dirty
+ */
+void UdpNet::flushAll() {
+	vector<int> pending;
+	{
+		lock_guard<mutex> guard(dirtyLock);
+		pending.swap(dirty);
+		flushing += pending.size();
+	}
+	for ( unsigned int i = 0; i < pending.size(); i++ ) {
+		flush(pending[i]);
+		flushing--;
+	}
+	while ( flushing > 0 ) {
+		this_thread::yield();
+	}
+}
+
+/**
+ * FUNCTION NAME: collect
+ *
+ * DESCRIPTION: Read the datagrams waiting on node dst's socket into frames in its shard,
+ * 				where they count as in flight again
+ */
+void UdpNet::collect(int dst, ENshard *shard) {
+	static thread_local vector<char> rx;
+	struct mmsghdr msgs[UDP_BATCH];
+	struct iovec iov[UDP_BATCH];
+	struct sockaddr_in from[UDP_BATCH];
+	int head = sizeof(int) + sizeof(unsigned int);
+	int slot = head + par->MAX_MSG_SIZE;
+	int n;
+
+	flushAll();
+	if ( dst >= (int)fds.size() || fds[dst] < 0 ) {
+		return;
+	}
+
+	rx.resize(UDP_BATCH * slot);
+	do {
+		memset(msgs, 0, sizeof(msgs));
+		for ( int i = 0; i < UDP_BATCH; i++ ) {
+			iov[i].iov_base = &rx[i * slot];
+			iov[i].iov_len = slot;
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_name = &from[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+		}
+
+		n = recvmmsg(fds[dst], msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+		for ( int i = 0; i < n; i++ ) {
+			int size = (int)msgs[i].msg_len - head;
+			if ( size < 0 ) {
+				continue;
+			}
+			en_frame *f = newFrame(size);
+			memcpy(&f->due, &rx[i * slot], sizeof(int));
+			memcpy(&f->seq, &rx[i * slot] + sizeof(int), sizeof(unsigned int));
+			*(int *)(f->msg.from.addr) = ntohs(from[i].sin_port) - portBase;
+			memcpy((char *)(f + 1), &rx[i * slot] + head, size);
+			emulnet.reserve(0);
+			shard->incoming.push(f);
+		}
+	} while ( n == UDP_BATCH );
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Count the last refused datagrams, discard unsent messages, then clean up
+ * 				as the in memory network does
+ */
+int UdpNet::ENcleanup() {
+	for ( unsigned int i = 0; i < outboxes.size(); i++ ) {
+		countRefused(i);
+		lock_guard<mutex> guard(outboxes[i]->lock);
+		for ( unsigned int j = 0; j < outboxes[i]->frames.size(); j++ ) {
+			releaseFrame(outboxes[i]->frames[j].second);
+		}
+		outboxes[i]->frames.clear();
+	}
+	dirty.clear();
+	return EmulNet::ENcleanup();
+}
@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: UdpNet.h
+ *
+ * DESCRIPTION: Header file of the UDP loopback transport
+ **********************************/
+
+#ifndef UDPNET_H_
+#define UDPNET_H_
+
+#include "stdincludes.h"
+#include "EmulNet.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+
+// datagrams per sendmmsg/recvmmsg call
+#define UDP_BATCH 64
+
+/**
+ * CLASS NAME: UdpNet
+ *
+ * DESCRIPTION: EmulNet whose messages travel as real UDP datagrams over 127.0.0.1.
+ * 				Node id i owns a socket bound to port portBase + i. Accepted messages wait
+ * 				in their sender's outbox and go out with sendmmsg once UDP_BATCH of them
+ * 				are queued, or before any node receives; ENrecv drains the node's socket
+ * 				with recvmmsg. A message counts against EN_BUFF_SIZE while it is in an
+ * 				outbox or a shard, not while the kernel holds it, so datagrams the kernel
+ * 				loses never hold on to room in the buffer. Drops, backpressure, link
+ * 				delays and statistics are otherwise the same as for the in memory network.
+ */
+class UdpNet : public EmulNet {
+private:
+	struct outbox {
+		mutex lock;
+		// destination id and frame of each queued message
+		vector< pair<int, en_frame *> > frames;
+		// ticks of messages the kernel refused, for the sender's own thread to count
+		vector<int> refused;
+	};
+	int portBase;
+	vector<int> fds;
+	vector<outbox *> outboxes;
+	// senders whose outbox may hold messages
+	mutex dirtyLock;
+	vector<int> dirty;
+	// senders taken off dirty whose flush has not finished yet
+	atomic<int> flushing;
+	void flush(int src);
+	void countRefused(int src);
+	void flushAll();
+protected:
+	bool post(int src, int dst, ENshard *shard, en_frame *f);
+	void collect(int dst, ENshard *shard);
+public:
+	UdpNet(Params *p, int lane);
+	virtual ~UdpNet();
+	void ENattach(Address *myaddr);
+	int ENcleanup();
+};
+
+#endif /* UDPNET_H_ */
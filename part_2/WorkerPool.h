@@ -0,0 +1,94 @@
+/**********************************
+ * FILE NAME: WorkerPool.h
+ *
+ * DESCRIPTION: Fixed set of worker threads that run one job at a time
+ **********************************/
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include "stdincludes.h"
+#include <condition_variable>
+
+/**
+ * CLASS NAME: WorkerPool
+ *
+ * DESCRIPTION: Threads started once and reused for every job.
+ * 				run(job) calls job(w) for every worker w, the calling thread being
+ * 				worker 0, and returns once all of them are done: the end of a job is
+ * 				a barrier. Between jobs the threads sleep on a condition variable.
+ */
+class WorkerPool {
+private:
+	mutex lock;
+	condition_variable wake;
+	condition_variable done;
+	vector<thread> threads;
+	const function<void(int)> *job;
+	// bumped for every job, tells a sleeping worker there is a new one
+	long generation;
+	// workers other than the caller still in the current job
+	int busy;
+	bool stopping;
+
+	void loop(int w) {
+		long seen = 0;
+		unique_lock<mutex> guard(lock);
+		for ( ;; ) {
+			wake.wait(guard, [&]() { return stopping || generation != seen; });
+			if ( stopping ) {
+				return;
+			}
+			seen = generation;
+			const function<void(int)> *current = job;
+			guard.unlock();
+			(*current)(w);
+			guard.lock();
+			if ( --busy == 0 ) {
+				done.notify_one();
+			}
+		}
+	}
+
+public:
+	WorkerPool(): job(NULL), generation(0), busy(0), stopping(false) {}
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool& operator = (const WorkerPool &) = delete;
+
+	// start the threads for count workers in all, the caller included
+	void start(int count) {
+		for ( int w = threads.size() + 1; w < count; w++ ) {
+			threads.push_back(thread(&WorkerPool::loop, this, w));
+		}
+	}
+
+	int size() {
+		return threads.size() + 1;
+	}
+
+	void run(const function<void(int)> &fn) {
+		{
+			lock_guard<mutex> guard(lock);
+			job = &fn;
+			busy = threads.size();
+			generation++;
+		}
+		wake.notify_all();
+		fn(0);
+		unique_lock<mutex> guard(lock);
+		done.wait(guard, [&]() { return busy == 0; });
+	}
+
+	virtual ~WorkerPool() {
+		{
+			lock_guard<mutex> guard(lock);
+			stopping = true;
+		}
+		wake.notify_all();
+		for ( unsigned int i = 0; i < threads.size(); i++ ) {
+			threads[i].join();
+		}
+	}
+};
+
+#endif /* WORKERPOOL_H_ */
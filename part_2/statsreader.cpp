@@ -0,0 +1,239 @@
+/**********************************
+ * FILE NAME: statsreader.cpp
+ *
+ * DESCRIPTION: Reader of the binary network statistics written with STATS_EXPORT.
+ * 				Prints run totals, per node totals and the busiest nodes, and can
+ * 				dump per tick cluster totals or the whole table as CSV for charting.
+ *
+ * 				statsreader <netstatsN.bin> [--ticks | --csv]
+ **********************************/
+
+#include "NetStats.h"
+
+/**
+ * CLASS NAME: StatsFile
+ *
+ * DESCRIPTION: A binary statistics file loaded into memory
+ */
+class StatsFile {
+public:
+	stats_header hdr;
+	vector<string> names;
+	vector<int32_t> data;
+	bool load(const char *path);
+	// value of column c for file node k at tick t
+	int32_t at(int c, int k, int t) {
+		return data[((size_t)c * hdr.nodes + k) * hdr.ticks + t];
+	}
+	// column c of file node k summed over the run
+	long long total(int c, int k) {
+		long long sum = 0;
+		for ( int t = 0; t < hdr.ticks; t++ ) {
+			sum += at(c, k, t);
+		}
+		return sum;
+	}
+};
+
+/**
+ * FUNCTION NAME: load
+ *
+ * DESCRIPTION: Read and check a statistics file
+ *
+ * RETURNS:
+ * true on success
+ */
+bool StatsFile::load(const char *path) {
+	char name[STATS_NAME_LEN];
+	FILE *fp = fopen(path, "rb");
+
+	if ( fp == NULL ) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+	if ( fread(&hdr, sizeof(hdr), 1, fp) != 1 || memcmp(hdr.magic, STATS_MAGIC, sizeof(hdr.magic)) != 0 || hdr.columns <= 0 || hdr.nodes < 0 || hdr.ticks < 0 ) {
+		fprintf(stderr, "%s is not a statistics file\n", path);
+		fclose(fp);
+		return false;
+	}
+	for ( int c = 0; c < hdr.columns; c++ ) {
+		if ( fread(name, sizeof(name), 1, fp) != 1 ) {
+			fclose(fp);
+			return false;
+		}
+		name[sizeof(name) - 1] = 0;
+		names.push_back(name);
+	}
+	data.resize((size_t)hdr.columns * hdr.nodes * hdr.ticks);
+	size_t got = fread(data.data(), sizeof(int32_t), data.size(), fp);
+	fclose(fp);
+	if ( got != data.size() ) {
+		fprintf(stderr, "%s is truncated\n", path);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * FUNCTION NAME: columnOf
+ *
+ * DESCRIPTION: Index of the named column, -1 if the file has none
+ */
+int columnOf(StatsFile &sf, const char *name) {
+	for ( unsigned int c = 0; c < sf.names.size(); c++ ) {
+		if ( sf.names[c] == name ) {
+			return c;
+		}
+	}
+	return -1;
+}
+
+/**
+ * FUNCTION NAME: peakOf
+ *
+ * DESCRIPTION: Largest value of column c for file node k
+ */
+long long peakOf(StatsFile &sf, int c, int k) {
+	long long peak = 0;
+	for ( int t = 0; t < sf.hdr.ticks; t++ ) {
+		peak = max(peak, (long long)sf.at(c, k, t));
+	}
+	return peak;
+}
+
+/**
+ * FUNCTION NAME: printCsv
+ *
+ * DESCRIPTION: One line per node and tick with every column
+ */
+void printCsv(StatsFile &sf) {
+	printf("node,tick");
+	for ( int c = 0; c < sf.hdr.columns; c++ ) {
+		printf(",%s", sf.names[c].c_str());
+	}
+	printf("\n");
+	for ( int k = 0; k < sf.hdr.nodes; k++ ) {
+		for ( int t = 0; t < sf.hdr.ticks; t++ ) {
+			printf("%d,%d", sf.hdr.firstId + k, t);
+			for ( int c = 0; c < sf.hdr.columns; c++ ) {
+				printf(",%d", sf.at(c, k, t));
+			}
+			printf("\n");
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: printTicks
+ *
+ * DESCRIPTION: Every column summed over the nodes, one line per tick
+ */
+void printTicks(StatsFile &sf) {
+	printf("tick");
+	for ( int c = 0; c < sf.hdr.columns; c++ ) {
+		printf(",%s", sf.names[c].c_str());
+	}
+	printf("\n");
+	for ( int t = 0; t < sf.hdr.ticks; t++ ) {
+		printf("%d", t);
+		for ( int c = 0; c < sf.hdr.columns; c++ ) {
+			long long sum = 0;
+			for ( int k = 0; k < sf.hdr.nodes; k++ ) {
+				sum += sf.at(c, k, t);
+			}
+			printf(",%lld", sum);
+		}
+		printf("\n");
+	}
+}
+
+/**
+ * FUNCTION NAME: printSummary
+ *
+ * DESCRIPTION: Run totals, per node totals, busiest nodes and the peak bandwidth tick
+ */
+void printSummary(StatsFile &sf) {
+	int sentBytes = columnOf(sf, "sent_bytes");
+	int recvBytes = columnOf(sf, "recv_bytes");
+	int depth = columnOf(sf, "depth");
+	vector< pair<long long, int> > load;
+
+	printf("%d nodes from id %d, %d ticks\n\n", sf.hdr.nodes, sf.hdr.firstId, sf.hdr.ticks);
+
+	printf("%-18s %12s\n", "column", "total");
+	for ( int c = 0; c < sf.hdr.columns; c++ ) {
+		long long sum = 0;
+		for ( int k = 0; k < sf.hdr.nodes; k++ ) {
+			sum += ( c == depth ) ? peakOf(sf, c, k) : sf.total(c, k);
+		}
+		printf("%-18s %12lld%s\n", sf.names[c].c_str(), sum, ( c == depth ) ? "  (sum of node peaks)" : "");
+	}
+
+	printf("\n%6s", "node");
+	for ( int c = 0; c < sf.hdr.columns; c++ ) {
+		printf(" %*s", (int)max((size_t)8, sf.names[c].size()), sf.names[c].c_str());
+	}
+	printf("\n");
+	for ( int k = 0; k < sf.hdr.nodes; k++ ) {
+		printf("%6d", sf.hdr.firstId + k);
+		for ( int c = 0; c < sf.hdr.columns; c++ ) {
+			// a depth is a level, not a count: show its peak
+			long long v = ( c == depth ) ? peakOf(sf, c, k) : sf.total(c, k);
+			printf(" %*lld", (int)max((size_t)8, sf.names[c].size()), v);
+		}
+		printf("\n");
+		long long bytes = (sentBytes >= 0 ? sf.total(sentBytes, k) : 0) + (recvBytes >= 0 ? sf.total(recvBytes, k) : 0);
+		load.push_back(make_pair(bytes, sf.hdr.firstId + k));
+	}
+
+	sort(load.rbegin(), load.rend());
+	printf("\nbusiest nodes by bytes sent + received:\n");
+	for ( unsigned int i = 0; i < load.size() && i < 5; i++ ) {
+		printf("  node %d: %lld bytes\n", load[i].second, load[i].first);
+	}
+
+	if ( sentBytes >= 0 && sf.hdr.ticks > 0 ) {
+		long long peak = -1, sum = 0;
+		int peakTick = 0;
+		for ( int t = 0; t < sf.hdr.ticks; t++ ) {
+			long long bytes = 0;
+			for ( int k = 0; k < sf.hdr.nodes; k++ ) {
+				bytes += sf.at(sentBytes, k, t);
+			}
+			sum += bytes;
+			if ( bytes > peak ) {
+				peak = bytes;
+				peakTick = t;
+			}
+		}
+		printf("\nbytes sent per tick: mean %.1f, peak %lld at tick %d\n", (double)sum / sf.hdr.ticks, peak, peakTick);
+	}
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Start from here
+ **********************************/
+int main(int argc, char *argv[]) {
+	StatsFile sf;
+
+	if ( argc < 2 || argc > 3 ) {
+		fprintf(stderr, "usage: %s <netstatsN.bin> [--ticks | --csv]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if ( !sf.load(argv[1]) ) {
+		return EXIT_FAILURE;
+	}
+
+	if ( argc == 3 && 0 == strcmp(argv[2], "--csv") ) {
+		printCsv(sf);
+	}
+	else if ( argc == 3 && 0 == strcmp(argv[2], "--ticks") ) {
+		printTicks(sf);
+	}
+	else {
+		printSummary(sf);
+	}
+	return EXIT_SUCCESS;
+}
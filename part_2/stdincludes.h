@@ -34,6 +34,11 @@
 #include <string>
 #include <algorithm>
 #include <queue>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
 #include <fstream>
 
 using namespace std;